@@ -4,6 +4,7 @@
  * 
  * This file contains all configurable parameters for expert-level
  * combat robot control systems based on competition standards.
+ * Included by src/SKV3_CombatRobot_Main.ino - change values here only.
  */
 
 #ifndef SKV3_CONFIG_H
@@ -42,11 +43,16 @@
 #define BLUETOOTH_BAUD_RATE     9600  // Standard HC-05 baud rate
 #define SERIAL_DEBUG_BAUD       115200 // High-speed debug serial
 #define COMMAND_BUFFER_SIZE     32    // Maximum command length
+#define COMMAND_IDLE_GAP_MS     5     // Line silence that ends an unterminated command
 #define RESPONSE_TARGET_MS      50    // Target response time under 50ms
 
 // Safety Protocol Constants (Competition Requirements)
 #define SAFETY_TIMEOUT_MS       500   // Maximum time without signal
-#define EMERGENCY_RESPONSE_US   1000  // Emergency stop response time (microseconds)
+#define LINK_HOLD_MS            150   // Link-loss tier 1: hold the last command through micro-dropouts
+#define LINK_HOLD_FOLLOW_RAMP   true  // Keep stepping the motor ramp towards the held command
+#define LINK_DECAY_RATE         750   // Link-loss tier 2: slew to stop (PWM units/s); tier 3 is SAFETY_TIMEOUT_MS
+#define EMERGENCY_RESPONSE_US   20    // E-stop ISR budget: edge to all outputs off (microseconds)
+#define ESTOP_REARM_HOLD_MS     250   // E-stop must stay released this long to re-arm
 #define WATCHDOG_TIMEOUT_MS     1000  // Backup watchdog timer
 #define LOW_VOLTAGE_CUTOFF_MV   9000  // 3.0V per cell for 3S LiPo
 
@@ -84,21 +90,40 @@
 #define COMPETITION_MODE              true   // Enable all safety features
 #define ALLOW_WEAPON_CONTROL          true   // Permit weapon operation
 #define REQUIRE_FAILSAFE              true   // Mandatory failsafe systems
-#define LOG_ALL_COMMANDS              false  // Command logging (debug only)
+#define ENABLE_BLACKBOX               true   // Match recorder: RAM ring, EEPROM on events
+
+// Black-Box Recorder (decode with tools/blackbox_dump)
+#define BLACKBOX_SAMPLE_MS            50     // Fixed sample rate into the RAM ring (20 Hz)
+#define BLACKBOX_RING_BYTES           256    // RAM ring: the last ~5s of hard driving, ~35s parked
+#define BLACKBOX_KEYFRAME_SAMPLES     40     // Absolute record at least this often (2s)
+#define BLACKBOX_EEPROM_START         64     // Below this is left for calibration data
+#define BLACKBOX_EEPROM_SLOTS         3      // Commits rotate across slots (wear levelling)
+#define BLACKBOX_COMMIT_BYTES_PER_LOOP 8     // EEPROM bytes compared per loop pass, at most one written
 
 // ===== EXPERT TUNING PARAMETERS =====
 
 // Motor Control Tuning
-#define DIFFERENTIAL_GAIN             1.0    // Differential drive sensitivity
-#define TURN_RATE_MULTIPLIER          0.8    // Turn speed adjustment
+#define DIFFERENTIAL_GAIN             256    // Differential drive sensitivity (Q8: 256 = 1.0)
+#define TURN_RATE_MULTIPLIER          205    // Turn speed adjustment (Q8: 205 = 0.8)
+#define DRIVE_MODE_DEFAULT            1      // M command mixing: 0 = tank, 1 = arcade, 2 = curvature
+#define DRIVE_THROTTLE_EXPO           0      // Throttle response curve (% cubic, 0 = linear)
+#define DRIVE_STEERING_EXPO           30     // Steering response curve (% cubic)
+#define DRIVE_QUICKTURN_THRESHOLD     20     // Curvature mode spins in place below this throttle
+#define DRIVE_QUICKTURN_BAND          16     // Throttle span, centred on the threshold, blending spin into curvature
+#define DIFFERENTIAL_CENTER           127    // M field for zero speed: 000 = full reverse, 254 = full forward
 #define ACCELERATION_SMOOTHING        0.3    // Motor acceleration filter
 #define DECELERATION_MULTIPLIER       1.5    // Faster deceleration
 
 // Communication Optimization  
 #define COMMAND_TIMEOUT_MS            100    // Individual command timeout
-#define BLUETOOTH_RETRY_COUNT         3      // Command retry attempts
-#define SIGNAL_STRENGTH_THRESHOLD     -80    // Minimum RSSI (dBm)
+#define BLUETOOTH_RETRY_COUNT         3      // Controller resends of an un-ACKed critical packet
+#define SIGNAL_STRENGTH_THRESHOLD     -80    // Minimum RSSI reported by the controller (dBm)
 #define PACKET_LOSS_THRESHOLD         5      // Max consecutive lost packets
+#define LINK_LOSS_LIMIT_PERCENT       20     // Recent packet loss that marks the link degraded
+#define LINK_DEGRADED_HOLD_MS         1000   // A loss burst or lost ACKs keep the link degraded this long
+#define LINK_SEQ_MODULO               100    // Two-digit packet sequence numbers wrap at 100
+#define LINK_SEQ_WINDOW               32     // Recent sequences remembered for duplicate detection
+#define LINK_RESYNC_MS                SAFETY_TIMEOUT_MS // Quiet this long: the next packet restarts the sequence window
 
 // Performance Monitoring
 #define ENABLE_PERFORMANCE_METRICS    false  // Performance measurement
@@ -68,6 +68,17 @@
 #define BLUETOOTH_BAUD_FAST 115200  // High-performance baud rate
 #define COMMAND_BUFFER_SIZE 32      // Buffer size for incoming commands
 #define COMMAND_TIMEOUT     50      // Command parsing timeout (ms)
+#define COMMAND_IDLE_GAP_MS 5       // Line silence that ends an unterminated command (ms)
+
+// Link Quality (sequenced packets: !<length><seq><command><data><checksum>#)
+#define LINK_SEQ_MODULO     100     // Two-digit sequence numbers wrap at 100
+#define LINK_SEQ_WINDOW     32      // Recent sequences remembered for duplicate detection
+#define BLUETOOTH_RETRY_COUNT 3     // Controller resends of an un-ACKed critical packet
+#define PACKET_LOSS_THRESHOLD 5     // Max consecutive lost packets
+#define SIGNAL_STRENGTH_THRESHOLD -80 // Minimum RSSI reported by the controller (dBm)
+#define LINK_LOSS_LIMIT_PERCENT 20  // Recent packet loss that marks the link degraded
+#define LINK_DEGRADED_HOLD_MS 1000  // A loss burst or lost ACKs keep the link degraded this long
+#define LINK_RESYNC_MS      RADIO_TIMEOUT // Quiet this long: the next packet restarts the sequence window
 
 // ============================================================================
 // SAFETY PROTOCOL CONSTANTS (Competition Requirements)
@@ -75,8 +86,16 @@
 
 // Timeout Settings
 #define RADIO_TIMEOUT       500     // Radio signal timeout (ms)
-#define WATCHDOG_TIMEOUT    1000    // Backup watchdog timeout (ms)
+#define LINK_HOLD_MS        150     // Link-loss tier 1: hold the last command through micro-dropouts (ms)
+#define LINK_HOLD_FOLLOW_RAMP false // Ramp commands in and finish the ramp during the hold (false: apply at once)
+#define LINK_RAMP_RATE      5000    // Command ramp when following (PWM units/s, ACCELERATION_RATE per loop)
+#define LINK_DECAY_RATE     750     // Link-loss tier 2: slew to stop (PWM units/s); tier 3 is RADIO_TIMEOUT
+#define WATCHDOG_TIMEOUT    1000    // Backup watchdog timeout (ms) - outputs cut at half, reset at full
+#define WATCHDOG_TASK_TIMEOUT 100   // Max gap between task heartbeats (ms)
+#define WATCHDOG_MAX_TASKS  8       // Heartbeat registry size
 #define EMERGENCY_RESPONSE  1       // Emergency stop response time (ms)
+#define EMERGENCY_RESPONSE_US 20    // E-stop ISR budget: edge to all outputs off (us)
+#define ESTOP_REARM_HOLD_MS 250     // E-stop must stay released this long to re-arm (ms)
 
 // Battery Safety (3S LiPo = 11.1V nominal)
 #define LOW_VOLTAGE_CUTOFF  9000    // 3.0V per cell (mV)
@@ -93,8 +112,14 @@
 // ============================================================================
 
 // Movement Characteristics
-#define DIFFERENTIAL_GAIN   1.0     // Differential drive sensitivity
-#define TURN_RATE_MULTIPLIER 0.8    // Turn rate scaling factor
+#define DIFFERENTIAL_GAIN   256     // Differential drive sensitivity (Q8: 256 = 1.0)
+#define TURN_RATE_MULTIPLIER 205    // Turn rate scaling factor (Q8: 205 = 0.8)
+#define DRIVE_MODE_DEFAULT  0       // M command mixing: 0 = tank, 1 = arcade, 2 = curvature
+#define DRIVE_THROTTLE_EXPO 0       // Throttle response curve (% cubic, 0 = linear)
+#define DRIVE_STEERING_EXPO 30      // Steering response curve (% cubic)
+#define DRIVE_QUICKTURN_THRESHOLD 20 // Curvature mode spins in place below this throttle
+#define DRIVE_QUICKTURN_BAND 16     // Throttle span, centred on the threshold, blending spin into curvature
+#define DIFFERENTIAL_CENTER 127     // M field for zero speed: 000 = full reverse, 254 = full forward
 #define MIN_EFFECTIVE_PWM   75      // Minimum PWM for reliable movement
 
 // Competition Modes
@@ -112,6 +137,8 @@
 #define ENABLE_PERFORMANCE_MONITOR false // Disable by default for competition
 #define ENABLE_SENSOR_FUSION    false   // Future sensor integration
 #define ENABLE_TELEMETRY        false   // Disable telemetry for competition
+#define ENABLE_SOFTWARE_WATCHDOG true   // Heartbeat-gated hardware watchdog
+#define ENABLE_BLACKBOX         true    // Match recorder: RAM ring, EEPROM on events
 
 // Debug and Testing
 #define DEBUG_MODE              false   // Disable debug output for performance
@@ -122,7 +149,15 @@
 #define SUPPORT_SINGLE_CHAR     true    // 'F', 'B', 'L', 'R', 'S'
 #define SUPPORT_SPEED_COMMANDS  true    // 'F180', 'B120'
 #define SUPPORT_DIFFERENTIAL    true    // 'M150200'
-#define SUPPORT_PACKET_PROTOCOL true    // '!05M15020099#'
+#define SUPPORT_PACKET_PROTOCOL true    // '!11M15020071#'
+
+// Black-Box Recorder (decode with tools/blackbox_dump)
+#define BLACKBOX_SAMPLE_MS      50      // Fixed sample rate into the RAM ring (20 Hz)
+#define BLACKBOX_RING_BYTES     256     // RAM ring: the last ~5s of hard driving, ~35s parked
+#define BLACKBOX_KEYFRAME_SAMPLES 40    // Absolute record at least this often (2s)
+#define BLACKBOX_EEPROM_START   64      // Below this is left for calibration data
+#define BLACKBOX_EEPROM_SLOTS   3       // Commits rotate across slots (wear levelling)
+#define BLACKBOX_COMMIT_BYTES_PER_LOOP 8 // EEPROM bytes compared per loop pass, at most one written
 
 // ============================================================================
 // CALIBRATION VALUES
@@ -139,7 +174,6 @@
 #define CURRENT_CALIBRATION 1.0     // Current sensor calibration factor
 
 // Timing Calibration
-#define LOOP_DELAY_MS       10      // Main loop delay for consistent timing
 #define SENSOR_UPDATE_RATE  100     // Sensor update frequency (ms)
 
 #endif // ROBOT_CONFIG_H
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef BLACK_BOX_H
+#define BLACK_BOX_H
+
+#include "Arduino.h"
+#include "BlackBoxFormat.h"
+#include "../config/robot_config.h"
+
+/*
+ * BlackBox Class
+ * Match recorder for after-the-fight analysis
+ * Samples commands, motor outputs, safety bits and battery voltage into a
+ * delta-encoded RAM ring at a fixed rate. The ring is only copied to
+ * EEPROM on events (e-stop, watchdog reset, match end), rotating across
+ * slots, one byte write per loop pass at most. The ring lives in .noinit
+ * RAM so a watchdog reset does not lose what led up to it.
+ */
+
+class BlackBox {
+public:
+    // Constructor
+    BlackBox();
+
+    // Initialization
+    void begin(uint8_t resetFlags);     // MCUSR-style: keeps a ring that survived a reset
+
+    // Recording
+    void noteCommand(char command);
+    void record(int16_t left, int16_t right, uint8_t safety, uint16_t batteryMv);  // Every loop pass
+    void event(uint8_t event);          // Logged with the next sample, then committed
+
+    // Background work: bounded, never waits on the EEPROM or the UART
+    void service();
+    bool startDump(Print& out);         // Serial download for tools/blackbox_dump
+    bool isCommitting();
+    bool isDumping();
+
+    // Status
+    uint16_t getUsed();                 // Bytes in the RAM ring
+    uint16_t getRecovered();            // Bytes that survived the last reset
+    unsigned long getCommits();
+    String getStatusString();
+
+private:
+    // Sampling
+    unsigned long _lastSample;
+    int16_t _lastLeft;
+    int16_t _lastRight;
+    uint8_t _lastSafety;
+    uint8_t _lastBattery;
+    char _command;
+    uint8_t _pendingEvent;
+    uint8_t _sinceKeyframe;
+    bool _forceKeyframe;
+    uint16_t _idleRun;                  // Ring position of the open idle-run record
+    uint16_t _recovered;
+
+    // EEPROM commit
+    bool _committing;
+    uint8_t _commitSlot;
+    uint8_t _commitReason;
+    uint16_t _commitStep;
+    uint16_t _commitLength;
+    uint16_t _commitTail;
+    uint8_t _commitSum;
+    uint16_t _sequence;                 // Of the newest committed slot
+    unsigned long _commits;
+
+    // Serial download
+    Print* _dumpOut;
+    uint8_t _dumpPhase;
+    uint16_t _dumpOffset;
+
+    // Internal methods
+    void _keyframe(uint8_t battery, uint8_t event);
+    void _append(const uint8_t* bytes, uint8_t length);
+    void _evictOldest();
+    uint16_t _tail();
+    bool _ringValid();
+    void _seal();
+    void _findNewestSlot();
+    uint16_t _slotAddress(uint8_t slot);
+    void _startCommit(uint8_t reason);
+    bool _commitByte(uint16_t step, uint16_t& address, uint8_t& value);
+    void _serviceCommit();
+    void _serviceDump();
+    static uint8_t _recordLength(uint8_t type);
+};
+
+#endif // BLACK_BOX_H
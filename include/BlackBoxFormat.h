@@ -0,0 +1,67 @@
+#ifndef BLACK_BOX_FORMAT_H
+#define BLACK_BOX_FORMAT_H
+
+/*
+ * Black-Box Record Format
+ * Shared by the firmware recorder and tools/blackbox_dump. Plain defines
+ * only, so the PC tool can use it without the Arduino core.
+ *
+ * One record per sample, BLACKBOX_SAMPLE_MS apart, oldest first:
+ *   keyframe  0x40, millis (u32), left (s16), right (s16), safety,
+ *             battery, command, event
+ *   delta     flags 0b00ECBSRL, then one byte per set flag in bit order:
+ *             left delta (s8), right delta (s8), safety, battery delta (s8),
+ *             command, event
+ *   idle run  0x80 | n: n samples with nothing changed (n = 1-127)
+ * Multi-byte fields are little-endian. Speeds are signed PWM, battery is
+ * in 50mV steps (0 = not measured), command is the last command letter
+ * received during the sample (0 = none).
+ */
+
+// Record types
+#define BLACKBOX_KEYFRAME           0x40
+#define BLACKBOX_KEYFRAME_BYTES     13
+#define BLACKBOX_IDLE_RUN           0x80
+#define BLACKBOX_IDLE_MAX           0x7F
+
+// Delta flags, payload in this order
+#define BLACKBOX_DELTA_LEFT         0x01
+#define BLACKBOX_DELTA_RIGHT        0x02
+#define BLACKBOX_DELTA_SAFETY       0x04
+#define BLACKBOX_DELTA_BATTERY      0x08
+#define BLACKBOX_DELTA_COMMAND      0x10
+#define BLACKBOX_DELTA_EVENT        0x20
+
+// Safety byte
+#define BLACKBOX_SAFETY_ESTOP       0x01
+#define BLACKBOX_SAFETY_TIMEOUT     0x02    // No command for the radio timeout
+#define BLACKBOX_SAFETY_LOW_VOLTAGE 0x04
+#define BLACKBOX_SAFETY_CRITICAL    0x08    // Critical battery voltage
+#define BLACKBOX_SAFETY_WEAPON      0x10    // Weapon spun up
+#define BLACKBOX_SAFETY_LINK        0x20    // Link degraded
+#define BLACKBOX_SAFETY_TIER_SHIFT  6       // Link-loss tier in bits 6-7
+#define BLACKBOX_BATTERY_STEP_MV    50
+
+// Events, also the reason a log was committed to EEPROM
+#define BLACKBOX_EVENT_NONE         0
+#define BLACKBOX_EVENT_ESTOP        1
+#define BLACKBOX_EVENT_WATCHDOG     2       // Recorded at boot from the surviving ring
+#define BLACKBOX_EVENT_MATCH_END    3
+#define BLACKBOX_EVENT_REBOOT       4       // Ring survived a non-watchdog reset: not committed
+
+// EEPROM slot: header, then the ring contents oldest record first
+//   magic (u16), sequence (u16), reason (u8), length (u16), checksum (u8)
+// The magic is written last, so a commit cut short by a power loss leaves
+// an invalid slot rather than a corrupt one.
+#define BLACKBOX_SLOT_MAGIC         0x4242  // "BB"
+#define BLACKBOX_SLOT_HEADER_BYTES  8
+
+// Serial download: "LOG" on the USB port, answered one line at a time with
+//   BB EEPROM <start> <slots> <slot bytes> <sample ms>
+//   BB <offset hex> <up to 16 data bytes hex>     (repeated)
+//   BB RAM <length>
+//   BB <offset hex> <data hex>                    (repeated)
+//   BB END
+#define BLACKBOX_DUMP_LINE_BYTES    16
+
+#endif // BLACK_BOX_FORMAT_H
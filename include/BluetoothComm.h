@@ -32,26 +32,35 @@ public:
     bool parseSpeedCommand(String cmd, char &direction, int &speed);
     bool parseDifferential(String cmd, int &leftSpeed, int &rightSpeed);
     bool parsePacketProtocol(String cmd, char &type, int &param1, int &param2);
+    bool parsePacket(String packet, int &sequence, char &type, String &data);
+    static int packetSequence(String packet);   // -1 for unsequenced packets
+    static int decodeAxis(int field);       // M field 000-254 -> -255..255
     
     // Response Methods
     void sendResponse(String response);
     void sendStatus(String status);
     void sendError(String error);
+    void sendAck(uint8_t sequence);         // Compact "K<seq>" for critical packets
     
     // Utility Methods
     void clearBuffer();
     uint8_t calculateChecksum(String data);
     bool isValidCommand(char cmd);
+    static bool isCriticalCommand(char cmd);    // ACKed and never run twice
 
 private:
     SoftwareSerial* _bluetooth;
     String _commandBuffer;
     unsigned long _lastCommandTime;
+    unsigned long _lastByteTime;
     bool _useHardwareSerial;
     
     // Internal methods
+    Stream* _port();
+    void _readAvailable();                  // Non-blocking drain of RX buffer
     void _flushInput();
     bool _isPacketComplete(String buffer);
+    static uint8_t _commandIndex(String packet);
     String _extractPacketData(String packet);
 };
 
@@ -64,8 +73,10 @@ enum CommandType {
     CMD_STOP = 'S',
     CMD_WEAPON = 'W',
     CMD_MOTOR = 'M',
+    CMD_DRIVE_MODE = 'D',
     CMD_EMERGENCY = 'E',
     CMD_STATUS = '?',
+    CMD_LINK_QUALITY = 'Q',
     CMD_INVALID = 0
 };
 
@@ -0,0 +1,55 @@
+#ifndef DRIVE_MIXER_H
+#define DRIVE_MIXER_H
+
+#include "Arduino.h"
+#include "../config/robot_config.h"
+
+/*
+ * DriveMixer Class
+ * Integer-only two-axis drive mixing for differential robots
+ * Tank, arcade and curvature modes with expo LUTs, Q8 gains and
+ * saturation that scales both sides together so the turn ratio survives.
+ * No floats and no 32-bit division: a mix is a few microseconds on AVR.
+ */
+
+// Mixing modes - how the two M command axes are read
+enum DriveMode {
+    DRIVE_MODE_TANK = 0,                // left, right
+    DRIVE_MODE_ARCADE = 1,              // throttle, steering (turn rate)
+    DRIVE_MODE_CURVATURE = 2            // throttle, curvature (turn radius)
+};
+
+#define DRIVE_EXPO_POINTS 17            // LUT knots every 16 counts over 0-256
+
+class DriveMixer {
+public:
+    // Constructor
+    DriveMixer();
+
+    // Configuration
+    void setMode(uint8_t mode);                             // DriveMode, ignored if invalid
+    uint8_t getMode() const;
+    void setExpo(uint8_t throttleExpo, uint8_t steeringExpo); // Percent cubic, 0 = linear
+    void setGains(uint16_t differentialGain, uint16_t turnRate); // Q8, 256 = 1.0
+
+    // Mixing: axes -255..255 in, motor speeds -255..255 out
+    void mix(int16_t axis1, int16_t axis2, int16_t &left, int16_t &right) const;
+
+    // Response curve lookup (exposed for tuning output)
+    int16_t applyThrottleCurve(int16_t value) const;
+    int16_t applySteeringCurve(int16_t value) const;
+
+private:
+    uint8_t _mode;
+    uint16_t _differentialGain;
+    uint16_t _turnRate;
+    uint16_t _throttleCurve[DRIVE_EXPO_POINTS];     // Q4 knots
+    uint16_t _steeringCurve[DRIVE_EXPO_POINTS];
+
+    // Internal methods
+    static void _buildCurve(uint16_t* curve, uint8_t expoPercent);
+    static int16_t _lookup(const uint16_t* curve, int16_t value);
+    static void _saturate(int16_t left, int16_t right, int16_t &outLeft, int16_t &outRight);
+};
+
+#endif // DRIVE_MIXER_H
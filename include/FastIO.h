@@ -0,0 +1,37 @@
+#ifndef FAST_IO_H
+#define FAST_IO_H
+
+#include "Arduino.h"
+
+/*
+ * FastIO - Direct register pin control for interrupt context
+ * Arduino Uno (ATmega328P) pin map. A handful of cycles per pin instead
+ * of ~60 for digitalWrite(), and no calls into the Arduino core.
+ */
+
+// Disconnect the timer output-compare channel driving a PWM pin
+inline void fastPwmDisconnect(uint8_t pin) {
+    switch (pin) {
+        case 3:  TCCR2A &= ~_BV(COM2B1); break;
+        case 5:  TCCR0A &= ~_BV(COM0B1); break;
+        case 6:  TCCR0A &= ~_BV(COM0A1); break;
+        case 9:  TCCR1A &= ~_BV(COM1A1); break;
+        case 10: TCCR1A &= ~_BV(COM1B1); break;
+        case 11: TCCR2A &= ~_BV(COM2A1); break;
+        default: break;
+    }
+}
+
+// Drive a pin LOW, stopping any PWM on it first
+inline void fastPinLow(uint8_t pin) {
+    fastPwmDisconnect(pin);
+    if (pin < 8) {
+        PORTD &= ~_BV(pin);
+    } else if (pin < 14) {
+        PORTB &= ~_BV(pin - 8);
+    } else if (pin < 20) {
+        PORTC &= ~_BV(pin - 14);
+    }
+}
+
+#endif // FAST_IO_H
@@ -0,0 +1,69 @@
+#ifndef LINK_LOSS_POLICY_H
+#define LINK_LOSS_POLICY_H
+
+#include "Arduino.h"
+#include "../config/robot_config.h"
+
+/*
+ * LinkLossPolicy Class
+ * Tiered drive output for Bluetooth dropouts
+ * Tier 1 holds the last command (optionally finishing its ramp), tier 2
+ * decays the speed through a time-based slew limiter, tier 3 stops hard
+ * at the radio timeout. Arena micro-dropouts of 50-200ms neither stutter
+ * nor freeze the robot; a dead link still stops it on time.
+ */
+
+// Link-loss tiers, by time since the last command of any kind
+enum LinkLossTier {
+    LINK_TIER_HOLD = 0,                 // Link live or briefly quiet: hold the command
+    LINK_TIER_DECAY = 1,                // Slew towards stop at the decay rate
+    LINK_TIER_STOP = 2                  // Radio timeout: outputs at zero
+};
+
+class LinkLossPolicy {
+public:
+    // Constructor
+    LinkLossPolicy();
+
+    // Initialization
+    void begin();
+    void configure(unsigned long holdMs, unsigned long stopMs,
+                   uint16_t rampRate, uint16_t decayRate, bool followRamp);
+
+    // Events
+    void linkAlive();                           // Any valid command arrived
+    void command(int16_t left, int16_t right);  // New drive target
+    void stop();                                // Explicit stop, no ramp
+
+    // Call every loop pass: returns true when the output should be rewritten
+    bool update(int16_t &left, int16_t &right);
+
+    // Status
+    uint8_t getTier();
+    unsigned long getQuietTime();               // ms since the last command
+    const char* getTierString();
+
+private:
+    unsigned long _holdMs;
+    unsigned long _stopMs;
+    uint16_t _rampRate;                 // PWM units per second towards the target
+    uint16_t _decayRate;                // PWM units per second towards stop
+    bool _followRamp;
+
+    int16_t _targetLeft;
+    int16_t _targetRight;
+    int16_t _outputLeft;
+    int16_t _outputRight;
+    bool _changed;
+    uint8_t _tier;
+
+    unsigned long _lastCommandTime;
+    unsigned long _lastUpdateTime;
+    uint32_t _slewCredit;               // Fractional slew carried between passes (x1000)
+
+    // Internal methods
+    int16_t _slewBudget(uint16_t rate, unsigned long elapsed);
+    static int16_t _slew(int16_t value, int16_t target, int16_t maxStep);
+};
+
+#endif // LINK_LOSS_POLICY_H
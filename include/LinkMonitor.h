@@ -0,0 +1,75 @@
+#ifndef LINK_MONITOR_H
+#define LINK_MONITOR_H
+
+#include "Arduino.h"
+#include "../config/robot_config.h"
+
+/*
+ * LinkMonitor Class
+ * Bluetooth link quality from packet sequence numbers
+ * Counts lost, reordered and duplicate packets, tracks inter-arrival
+ * jitter, and decides when the link is too poor to trust with a weapon.
+ * Duplicate detection also stops a retransmitted critical command from
+ * running twice.
+ */
+
+// What to do with a sequenced packet
+enum LinkVerdict {
+    LINK_NEW = 0,                       // Newest so far: execute
+    LINK_LATE = 1,                      // Older than the newest, first copy: execute only if critical
+    LINK_DUPLICATE = 2,                 // Seen before: drop (re-ACK if critical)
+    LINK_STALE = 3                      // Too old to tell: execute only if critical
+};
+
+class LinkMonitor {
+public:
+    // Constructor
+    LinkMonitor();
+    void reset();
+
+    // Packet tracking
+    uint8_t onPacket(uint8_t sequence, bool critical);  // Returns LinkVerdict
+    void updateSignalStrength(int rssi);                // dBm, reported by the controller
+
+    // Link status
+    bool isDegraded();
+    unsigned long getReceived();
+    unsigned long getLost();
+    unsigned long getReordered();
+    unsigned long getDuplicates();
+    uint8_t getLossPercent();           // Recent loss (moving average)
+    uint16_t getJitterMs();             // Smoothed inter-arrival variation
+    int getSignalStrength();
+
+    // Status and Diagnostics
+    String getStatusString();
+
+private:
+    bool _started;
+    unsigned long _lastPacket;          // Any verdict; a long silence resyncs
+    uint8_t _highest;                   // Newest sequence received
+    uint32_t _window;                   // Bit n set: (_highest - n) received
+
+    unsigned long _received;
+    unsigned long _lost;
+    unsigned long _reordered;
+    unsigned long _duplicates;
+    uint16_t _lossAverage;              // Recent loss, percent in Q8
+    uint16_t _jitterQ4;                 // Jitter in ms, Q4
+    unsigned long _lastArrival;
+    unsigned long _lastInterval;
+
+    uint8_t _retrySequence;             // Critical packet being resent
+    uint8_t _retries;
+    int _signalStrength;
+    bool _burstActive;                  // Loss burst or ACK failure seen recently
+    unsigned long _burstTime;
+
+    // Internal methods
+    void _recordLoss(uint8_t count);
+    void _recordArrival(uint8_t steps);
+    void _flagBurst();
+    uint8_t _percentOf(unsigned long count);
+};
+
+#endif // LINK_MONITOR_H
@@ -2,6 +2,7 @@
 #define SAFETY_SYSTEM_H
 
 #include "Arduino.h"
+#include "FastIO.h"
 #include "../config/robot_config.h"
 
 /*
@@ -17,7 +18,8 @@ public:
     
     // Initialization
     void begin();
-    void attachEmergencyStop(void (*callback)());
+    void attachEmergencyStop(void (*callback)());  // Runs in the e-stop ISR: register writes only
+    void attachRearm(void (*callback)());          // Runs from update() once re-armed
     
     // Safety Monitoring
     void update();                          // Call in main loop
@@ -30,6 +32,8 @@ public:
     void resetCommunicationTimeout();     // Reset radio timeout
     bool isCommunicationTimeout();        // Check if communication lost
     void setRadioTimeout(unsigned long timeout);
+    void setLinkDegraded(bool degraded);  // From LinkMonitor: too lossy for the weapon
+    bool isLinkDegraded();
     
     // Battery Management
     void updateBatteryVoltage(float voltage);
@@ -39,8 +43,9 @@ public:
     
     // Emergency Procedures
     void triggerEmergencyStop();          // Software emergency stop
-    void clearEmergencyStop();           // Clear emergency state
+    bool clearEmergencyStop();           // Start the re-arm sequence (false if still pressed)
     bool isEmergencyActive();            // Check emergency status
+    bool isRearming();                   // Re-arm sequence in progress
     
     // Status and Diagnostics
     void printStatus();                  // Print safety status
@@ -57,6 +62,7 @@ private:
     unsigned long _lastCommandTime;
     unsigned long _radioTimeout;
     unsigned long _watchdogTimeout;
+    bool _linkDegraded;
     
     // Battery monitoring
     float _batteryVoltage;
@@ -66,6 +72,8 @@ private:
     // Emergency stop state
     volatile bool _emergencyStopActive;
     volatile bool _hardwareEmergencyStop;
+    volatile uint8_t _estopState;
+    unsigned long _rearmStartTime;
     
     // Weapon safety
     unsigned long _weaponStartTime;
@@ -76,10 +84,21 @@ private:
     void _initializeInterrupts();
     float _readBatteryVoltage();
     void _updateStatusLED();
+    void _updateRearm();
     
     // Static interrupt handler
     static void _emergencyStopISR();
+    static void _cutOutputs();
     static SafetySystem* _instance;
+    static void (*_emergencyCallback)();
+    static void (*_rearmCallback)();
+};
+
+// Emergency stop states
+enum EstopState {
+    ESTOP_ARMED = 0,                    // Normal operation
+    ESTOP_TRIPPED = 1,                  // Outputs cut, waiting for re-arm request
+    ESTOP_REARMING = 2                  // Released, waiting out ESTOP_REARM_HOLD_MS
 };
 
 // Safety status codes
@@ -89,7 +108,8 @@ enum SafetyStatus {
     SAFETY_CRITICAL_VOLTAGE = 2,
     SAFETY_COMMUNICATION_TIMEOUT = 4,
     SAFETY_EMERGENCY_STOP = 8,
-    SAFETY_WEAPON_UNSAFE = 16
+    SAFETY_WEAPON_UNSAFE = 16,
+    SAFETY_LINK_DEGRADED = 32
 };
 
 #endif // SAFETY_SYSTEM_H
\ No newline at end of file
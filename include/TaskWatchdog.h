@@ -0,0 +1,59 @@
+#ifndef TASK_WATCHDOG_H
+#define TASK_WATCHDOG_H
+
+#include "Arduino.h"
+#include "../config/robot_config.h"
+
+/*
+ * TaskWatchdog Class
+ * Hardware watchdog gated by per-task heartbeats
+ * Every periodic task checks in; the AVR WDT is only fed while all of them
+ * are on time. On expiry the WDT interrupt runs a pre-reset hook that cuts
+ * the outputs, then the next WDT period resets the chip.
+ */
+
+class TaskWatchdog {
+public:
+    // Constructor
+    TaskWatchdog();
+
+    // Initialization
+    void begin();                           // Capture reset cause, WDT off
+    void enable();                          // Arm WDT (after slow setup steps)
+    void disable();
+    void attachPreResetHook(void (*hook)()); // Runs in the WDT interrupt
+
+    // Heartbeat Registry
+    uint8_t registerTask(unsigned long maxIntervalMs = WATCHDOG_TASK_TIMEOUT);
+    void checkIn(uint8_t taskId);
+    void update();                          // Call in main loop: feeds WDT if healthy
+    bool isHealthy();
+    uint8_t getStaleTasks();                // Bitmask of late tasks
+
+    // Reset Diagnostics (previous boot)
+    bool wasWatchdogReset();
+    uint8_t getResetFlags();                // MCUSR-style WDRF/BORF/EXTRF/PORF
+    uint8_t getLastStaleTasks();            // Tasks that starved the previous run
+    String getResetString();
+
+    // Called from ISR(WDT_vect)
+    static void handleInterrupt();
+
+private:
+    unsigned long _lastCheckIn[WATCHDOG_MAX_TASKS];
+    unsigned long _maxInterval[WATCHDOG_MAX_TASKS];
+    uint8_t _taskCount;
+    uint8_t _resetFlags;
+    uint8_t _lastStaleTasks;
+    bool _enabled;
+
+    // Internal methods
+    static uint8_t _prescaler(unsigned long periodMs);
+
+    static TaskWatchdog* _instance;
+    static void (*_preResetHook)();
+};
+
+#define WATCHDOG_INVALID_TASK 0xFF
+
+#endif // TASK_WATCHDOG_H
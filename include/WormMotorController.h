@@ -2,6 +2,7 @@
 #define WORM_MOTOR_CONTROLLER_H
 
 #include "Arduino.h"
+#include "FastIO.h"
 #include "../config/robot_config.h"
 
 /*
@@ -24,6 +25,8 @@ public:
     void setSpeedSmooth(int16_t speed);     // Set speed with acceleration ramping
     void stop();                            // Immediate stop
     void emergencyStop();                   // Emergency stop (interrupt safe)
+    void killFromISR();                     // Register-level output cut for ISRs
+    void clearEmergencyStop();              // Re-arm after an emergency stop
     void brake();                           // Active braking
     
     // Status Methods
@@ -52,9 +55,9 @@ private:
     uint8_t _accelRate;
     
     // Current state
-    int16_t _currentSpeed;
-    int16_t _targetSpeed;
-    bool _emergencyStopActive;
+    volatile int16_t _currentSpeed;
+    volatile int16_t _targetSpeed;
+    volatile bool _emergencyStopActive;
     
     // Internal methods
     void _setDirection(bool forward);
@@ -62,4 +65,6 @@ private:
     uint8_t _applyDeadband(uint8_t rawPWM);
     int16_t _applyTrim(int16_t speed);
     void _updatePWMFrequency();
-};
\ No newline at end of file
+};
+
+#endif // WORM_MOTOR_CONTROLLER_H
\ No newline at end of file
@@ -0,0 +1,477 @@
+#include "../include/BlackBox.h"
+#include <avr/eeprom.h>
+
+/*
+ * BlackBox Implementation
+ * Records are appended whole and evicted whole from the oldest end, so
+ * the ring always starts on a record boundary; the decoder skips deltas
+ * until the first keyframe. While a commit or download is reading the
+ * ring, sampling pauses and resumes with a keyframe.
+ */
+
+#define BLACKBOX_RING_MAGIC  0xB10C
+#define BLACKBOX_NO_RUN      0xFFFF
+#define BLACKBOX_SLOT_BYTES  (BLACKBOX_SLOT_HEADER_BYTES + BLACKBOX_RING_BYTES)
+
+#if BLACKBOX_EEPROM_START + BLACKBOX_EEPROM_SLOTS * BLACKBOX_SLOT_BYTES > E2END + 1
+#error "Black-box EEPROM slots do not fit: reduce BLACKBOX_RING_BYTES or BLACKBOX_EEPROM_SLOTS"
+#endif
+
+// Dump phases
+#define DUMP_EEPROM_HEADER   0
+#define DUMP_EEPROM_DATA     1
+#define DUMP_RAM_HEADER      2
+#define DUMP_RAM_DATA        3
+#define DUMP_END             4
+
+// Survives a watchdog or external reset (not zeroed by the C runtime)
+struct BlackBoxRing {
+    uint16_t magic;
+    uint16_t head;                      // Next byte to write
+    uint16_t used;                      // Bytes holding records
+    uint16_t check;                     // magic ^ head ^ used, sealed after every change
+    uint8_t data[BLACKBOX_RING_BYTES];
+};
+static BlackBoxRing _ring __attribute__((section(".noinit")));
+
+// Header bytes 2-7 first, then the magic, so a cut-short commit stays invalid
+static const uint8_t HEADER_ORDER[BLACKBOX_SLOT_HEADER_BYTES] = { 2, 3, 4, 5, 6, 7, 1, 0 };
+
+static uint8_t _eepromRead(uint16_t address) {
+    return eeprom_read_byte((const uint8_t*)(uintptr_t)address);
+}
+
+static char _hexDigit(uint8_t value) {
+    return value < 10 ? '0' + value : 'A' + value - 10;
+}
+
+static char* _appendHex(char* out, uint8_t value) {
+    *out++ = _hexDigit(value >> 4);
+    *out++ = _hexDigit(value & 0x0F);
+    return out;
+}
+
+static char* _appendNumber(char* out, unsigned int value) {
+    char digits[6];
+    uint8_t count = 0;
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    while (count > 0) *out++ = digits[--count];
+    return out;
+}
+
+BlackBox::BlackBox()
+    : _lastSample(0), _lastLeft(0), _lastRight(0), _lastSafety(0), _lastBattery(0),
+      _command(0), _pendingEvent(BLACKBOX_EVENT_NONE), _sinceKeyframe(0),
+      _forceKeyframe(true), _idleRun(BLACKBOX_NO_RUN), _recovered(0),
+      _committing(false), _commitSlot(0), _commitReason(BLACKBOX_EVENT_NONE),
+      _commitStep(0), _commitLength(0), _commitTail(0), _commitSum(0),
+      _sequence(0), _commits(0),
+      _dumpOut(nullptr), _dumpPhase(DUMP_END), _dumpOffset(0) {
+}
+
+void BlackBox::begin(uint8_t resetFlags) {
+    _findNewestSlot();
+
+    // RAM is garbage after a power-on; after any other reset what led up
+    // to it is still there. A watchdog reset is worth keeping, anything
+    // else just carries on recording.
+    if (!(resetFlags & _BV(PORF)) && _ringValid()) {
+        _recovered = _ring.used;
+        _pendingEvent = (resetFlags & _BV(WDRF)) ? BLACKBOX_EVENT_WATCHDOG : BLACKBOX_EVENT_REBOOT;
+    } else {
+        _ring.magic = BLACKBOX_RING_MAGIC;
+        _ring.head = 0;
+        _ring.used = 0;
+        _seal();
+        _recovered = 0;
+    }
+
+    _committing = false;
+    _dumpOut = nullptr;
+    _forceKeyframe = true;
+    _idleRun = BLACKBOX_NO_RUN;
+    _lastSample = millis() - BLACKBOX_SAMPLE_MS;
+}
+
+// Recording
+void BlackBox::noteCommand(char command) {
+    _command = command;
+}
+
+void BlackBox::record(int16_t left, int16_t right, uint8_t safety, uint16_t batteryMv) {
+    unsigned long now = millis();
+    if (now - _lastSample < BLACKBOX_SAMPLE_MS) return;
+
+    // Paused while the ring is being read out; a stalled loop also breaks
+    // the fixed-rate timeline. Either way, restart it with a keyframe.
+    bool paused = _committing || _dumpOut;
+    if (paused || now - _lastSample >= 2 * BLACKBOX_SAMPLE_MS) {
+        _forceKeyframe = true;
+        _lastSample = now;
+        if (paused) return;
+    } else {
+        _lastSample += BLACKBOX_SAMPLE_MS;
+    }
+
+    uint16_t steps = batteryMv / BLACKBOX_BATTERY_STEP_MV;
+    uint8_t battery = steps > 255 ? 255 : steps;
+    int leftDelta = left - _lastLeft;
+    int rightDelta = right - _lastRight;
+    int batteryDelta = battery - _lastBattery;
+    bool fits = leftDelta >= -128 && leftDelta <= 127 &&
+                rightDelta >= -128 && rightDelta <= 127 &&
+                batteryDelta >= -128 && batteryDelta <= 127;
+
+    uint8_t event = _pendingEvent;
+    _pendingEvent = BLACKBOX_EVENT_NONE;
+
+    if (_forceKeyframe || !fits || ++_sinceKeyframe >= BLACKBOX_KEYFRAME_SAMPLES) {
+        _lastLeft = left;
+        _lastRight = right;
+        _lastSafety = safety;
+        _lastBattery = battery;
+        _keyframe(battery, event);
+    } else {
+        uint8_t record[7];
+        uint8_t length = 1;
+        if (leftDelta != 0)       record[length++] = (uint8_t)leftDelta;
+        if (rightDelta != 0)      record[length++] = (uint8_t)rightDelta;
+        if (safety != _lastSafety) record[length++] = safety;
+        if (batteryDelta != 0)    record[length++] = (uint8_t)batteryDelta;
+        if (_command != 0)        record[length++] = (uint8_t)_command;
+        if (event != 0)           record[length++] = event;
+        record[0] = (leftDelta != 0 ? BLACKBOX_DELTA_LEFT : 0) |
+                    (rightDelta != 0 ? BLACKBOX_DELTA_RIGHT : 0) |
+                    (safety != _lastSafety ? BLACKBOX_DELTA_SAFETY : 0) |
+                    (batteryDelta != 0 ? BLACKBOX_DELTA_BATTERY : 0) |
+                    (_command != 0 ? BLACKBOX_DELTA_COMMAND : 0) |
+                    (event != 0 ? BLACKBOX_DELTA_EVENT : 0);
+
+        _lastLeft = left;
+        _lastRight = right;
+        _lastSafety = safety;
+        _lastBattery = battery;
+
+        if (record[0] != 0) {
+            _append(record, length);
+            _idleRun = BLACKBOX_NO_RUN;
+        } else if (_idleRun != BLACKBOX_NO_RUN && _ring.data[_idleRun] != (BLACKBOX_IDLE_RUN | BLACKBOX_IDLE_MAX)) {
+            // Nothing changed: one more sample on the open idle run
+            _ring.data[_idleRun]++;
+        } else {
+            uint8_t run = BLACKBOX_IDLE_RUN | 1;
+            _append(&run, 1);
+            _idleRun = (_ring.head + BLACKBOX_RING_BYTES - 1) % BLACKBOX_RING_BYTES;
+        }
+    }
+    _command = 0;
+
+    if (event == BLACKBOX_EVENT_ESTOP || event == BLACKBOX_EVENT_WATCHDOG ||
+        event == BLACKBOX_EVENT_MATCH_END) {
+        _startCommit(event);
+    }
+}
+
+void BlackBox::event(uint8_t event) {
+    // The first event wins until it has been logged
+    if (_pendingEvent == BLACKBOX_EVENT_NONE) _pendingEvent = event;
+}
+
+// Background work
+void BlackBox::service() {
+    if (_committing) {
+        _serviceCommit();
+    } else if (_dumpOut) {
+        _serviceDump();
+    }
+}
+
+bool BlackBox::startDump(Print& out) {
+    if (_committing || _dumpOut) return false;
+    _dumpOut = &out;
+    _dumpPhase = DUMP_EEPROM_HEADER;
+    _dumpOffset = 0;
+    return true;
+}
+
+bool BlackBox::isCommitting() {
+    return _committing;
+}
+
+bool BlackBox::isDumping() {
+    return _dumpOut != nullptr;
+}
+
+// Status
+uint16_t BlackBox::getUsed() {
+    return _ring.used;
+}
+
+uint16_t BlackBox::getRecovered() {
+    return _recovered;
+}
+
+unsigned long BlackBox::getCommits() {
+    return _commits;
+}
+
+String BlackBox::getStatusString() {
+    String status = "BLACKBOX ";
+    status += String(_ring.used);
+    status += "/";
+    status += String(BLACKBOX_RING_BYTES);
+    status += "B commits=";
+    status += String(_commits);
+    if (_committing) status += " COMMITTING";
+    if (_dumpOut) status += " DUMPING";
+    return status;
+}
+
+// Private Methods - ring
+void BlackBox::_keyframe(uint8_t battery, uint8_t event) {
+    uint8_t record[BLACKBOX_KEYFRAME_BYTES];
+    unsigned long time = _lastSample;
+    record[0] = BLACKBOX_KEYFRAME;
+    for (uint8_t i = 0; i < 4; i++) record[1 + i] = (uint8_t)(time >> (8 * i));
+    record[5] = (uint8_t)_lastLeft;
+    record[6] = (uint8_t)((uint16_t)_lastLeft >> 8);
+    record[7] = (uint8_t)_lastRight;
+    record[8] = (uint8_t)((uint16_t)_lastRight >> 8);
+    record[9] = _lastSafety;
+    record[10] = battery;
+    record[11] = (uint8_t)_command;
+    record[12] = event;
+
+    _append(record, BLACKBOX_KEYFRAME_BYTES);
+    _forceKeyframe = false;
+    _sinceKeyframe = 0;
+    _idleRun = BLACKBOX_NO_RUN;
+}
+
+void BlackBox::_append(const uint8_t* bytes, uint8_t length) {
+    while (BLACKBOX_RING_BYTES - _ring.used < length) _evictOldest();
+
+    for (uint8_t i = 0; i < length; i++) {
+        _ring.data[_ring.head] = bytes[i];
+        _ring.head = (_ring.head + 1) % BLACKBOX_RING_BYTES;
+    }
+    _ring.used += length;
+    _seal();
+}
+
+void BlackBox::_evictOldest() {
+    uint16_t tail = _tail();
+    if (tail == _idleRun) _idleRun = BLACKBOX_NO_RUN;
+    uint8_t length = _recordLength(_ring.data[tail]);
+    _ring.used -= min((uint16_t)length, _ring.used);
+}
+
+uint16_t BlackBox::_tail() {
+    return (_ring.head + BLACKBOX_RING_BYTES - _ring.used) % BLACKBOX_RING_BYTES;
+}
+
+bool BlackBox::_ringValid() {
+    if (_ring.magic != BLACKBOX_RING_MAGIC || _ring.head >= BLACKBOX_RING_BYTES ||
+        _ring.used > BLACKBOX_RING_BYTES ||
+        _ring.check != (uint16_t)(_ring.magic ^ _ring.head ^ _ring.used)) {
+        return false;
+    }
+
+    // Records must tile the used bytes exactly
+    uint16_t position = _tail();
+    uint16_t walked = 0;
+    while (walked < _ring.used) {
+        walked += _recordLength(_ring.data[position]);
+        position = (_tail() + walked) % BLACKBOX_RING_BYTES;
+    }
+    return walked == _ring.used;
+}
+
+void BlackBox::_seal() {
+    _ring.check = _ring.magic ^ _ring.head ^ _ring.used;
+}
+
+uint8_t BlackBox::_recordLength(uint8_t type) {
+    if (type & BLACKBOX_IDLE_RUN) return 1;
+    if (type == BLACKBOX_KEYFRAME) return BLACKBOX_KEYFRAME_BYTES;
+
+    uint8_t length = 1;
+    for (uint8_t bit = BLACKBOX_DELTA_LEFT; bit <= BLACKBOX_DELTA_EVENT; bit <<= 1) {
+        if (type & bit) length++;
+    }
+    return length;
+}
+
+// Private Methods - EEPROM
+uint16_t BlackBox::_slotAddress(uint8_t slot) {
+    return BLACKBOX_EEPROM_START + slot * BLACKBOX_SLOT_BYTES;
+}
+
+void BlackBox::_findNewestSlot() {
+    // Commits go round the slots in turn; continue after the newest
+    bool found = false;
+    uint8_t newest = BLACKBOX_EEPROM_SLOTS - 1;
+    for (uint8_t slot = 0; slot < BLACKBOX_EEPROM_SLOTS; slot++) {
+        uint16_t base = _slotAddress(slot);
+        uint16_t magic = _eepromRead(base) | (_eepromRead(base + 1) << 8);
+        if (magic != BLACKBOX_SLOT_MAGIC) continue;
+
+        uint16_t sequence = _eepromRead(base + 2) | (_eepromRead(base + 3) << 8);
+        if (!found || (int16_t)(sequence - _sequence) > 0) {
+            found = true;
+            newest = slot;
+            _sequence = sequence;
+        }
+    }
+    _commitSlot = (newest + 1) % BLACKBOX_EEPROM_SLOTS;
+}
+
+void BlackBox::_startCommit(uint8_t reason) {
+    _committing = true;
+    _commitReason = reason;
+    _commitStep = 0;
+    _commitLength = _ring.used;
+    _commitTail = _tail();
+    _commitSum = 0;
+}
+
+bool BlackBox::_commitByte(uint16_t step, uint16_t& address, uint8_t& value) {
+    uint16_t base = _slotAddress(_commitSlot);
+
+    // Step 0: clear the old magic before touching the slot's data
+    if (step == 0) {
+        address = base;
+        value = _eepromRead(base) == (BLACKBOX_SLOT_MAGIC & 0xFF) ? 0 : _eepromRead(base);
+        return true;
+    }
+
+    // Then the ring contents, oldest record first
+    if (step <= _commitLength) {
+        address = base + BLACKBOX_SLOT_HEADER_BYTES + step - 1;
+        value = _ring.data[(_commitTail + step - 1) % BLACKBOX_RING_BYTES];
+        return true;
+    }
+
+    // Then the header, magic last
+    uint16_t index = step - _commitLength - 1;
+    if (index >= BLACKBOX_SLOT_HEADER_BYTES) return false;
+
+    uint16_t sequence = _sequence + 1;
+    uint8_t header[BLACKBOX_SLOT_HEADER_BYTES] = {
+        (uint8_t)BLACKBOX_SLOT_MAGIC, (uint8_t)(BLACKBOX_SLOT_MAGIC >> 8),
+        (uint8_t)sequence, (uint8_t)(sequence >> 8),
+        _commitReason,
+        (uint8_t)_commitLength, (uint8_t)(_commitLength >> 8),
+        _commitSum
+    };
+    address = base + HEADER_ORDER[index];
+    value = header[HEADER_ORDER[index]];
+    return true;
+}
+
+void BlackBox::_serviceCommit() {
+    // Compare a few bytes per pass and start at most one write: an EEPROM
+    // write runs 3.4ms in the background, so the loop never waits for it
+    for (uint8_t n = 0; n < BLACKBOX_COMMIT_BYTES_PER_LOOP; n++) {
+        if (!eeprom_is_ready()) return;
+
+        uint16_t address;
+        uint8_t value;
+        if (!_commitByte(_commitStep, address, value)) {
+            _committing = false;
+            _sequence++;
+            _commits++;
+            _commitSlot = (_commitSlot + 1) % BLACKBOX_EEPROM_SLOTS;
+            return;
+        }
+
+        if (_commitStep > 0 && _commitStep <= _commitLength) _commitSum += value;
+        _commitStep++;
+
+        // Unchanged bytes cost no wear
+        if (_eepromRead(address) != value) {
+            eeprom_write_byte((uint8_t*)(uintptr_t)address, value);
+            return;
+        }
+    }
+}
+
+// Private Methods - download
+void BlackBox::_serviceDump() {
+    char line[8 + 2 * BLACKBOX_DUMP_LINE_BYTES + 2 + 1];
+    char* out = line;
+    uint16_t eepromBytes = BLACKBOX_EEPROM_SLOTS * BLACKBOX_SLOT_BYTES;
+    uint8_t nextPhase = _dumpPhase;
+    uint16_t nextOffset = _dumpOffset;
+
+    memcpy(out, "BB ", 3);
+    out += 3;
+
+    switch (_dumpPhase) {
+        case DUMP_EEPROM_HEADER:
+            memcpy(out, "EEPROM ", 7);
+            out = _appendNumber(out + 7, BLACKBOX_EEPROM_START);
+            *out++ = ' ';
+            out = _appendNumber(out, BLACKBOX_EEPROM_SLOTS);
+            *out++ = ' ';
+            out = _appendNumber(out, BLACKBOX_SLOT_BYTES);
+            *out++ = ' ';
+            out = _appendNumber(out, BLACKBOX_SAMPLE_MS);
+            nextPhase = DUMP_EEPROM_DATA;
+            nextOffset = 0;
+            break;
+
+        case DUMP_RAM_HEADER:
+            memcpy(out, "RAM ", 4);
+            out = _appendNumber(out + 4, _ring.used);
+            nextPhase = DUMP_RAM_DATA;
+            nextOffset = 0;
+            break;
+
+        case DUMP_EEPROM_DATA:
+        case DUMP_RAM_DATA: {
+            bool eeprom = _dumpPhase == DUMP_EEPROM_DATA;
+            uint16_t total = eeprom ? eepromBytes : _ring.used;
+            uint16_t count = min((uint16_t)(total - _dumpOffset), (uint16_t)BLACKBOX_DUMP_LINE_BYTES);
+            out = _appendHex(out, _dumpOffset >> 8);
+            out = _appendHex(out, _dumpOffset & 0xFF);
+            *out++ = ' ';
+            for (uint16_t i = 0; i < count; i++) {
+                uint16_t offset = _dumpOffset + i;
+                uint8_t value = eeprom ? _eepromRead(BLACKBOX_EEPROM_START + offset)
+                                       : _ring.data[(_tail() + offset) % BLACKBOX_RING_BYTES];
+                out = _appendHex(out, value);
+            }
+            nextOffset = _dumpOffset + count;
+            if (nextOffset >= total) nextPhase = eeprom ? DUMP_RAM_HEADER : DUMP_END;
+            break;
+        }
+
+        default:
+            memcpy(out, "END", 3);
+            out += 3;
+            nextPhase = DUMP_END + 1;
+            break;
+    }
+
+    // A data phase with nothing in it goes straight on
+    if (_dumpPhase == DUMP_RAM_DATA && _ring.used == 0) {
+        _dumpPhase = DUMP_END;
+        return;
+    }
+
+    *out++ = '\r';
+    *out++ = '\n';
+    *out = '\0';
+
+    // Only send what fits in the TX buffer: never block the loop
+    if (_dumpOut->availableForWrite() < (int)(out - line)) return;
+    _dumpOut->write(line);
+
+    _dumpPhase = nextPhase;
+    _dumpOffset = nextOffset;
+    if (_dumpPhase > DUMP_END) _dumpOut = nullptr;
+}
@@ -14,6 +14,7 @@ BluetoothComm::BluetoothComm(uint8_t rxPin, uint8_t txPin) {
         _bluetooth = new SoftwareSerial(rxPin, txPin);
     }
     _lastCommandTime = 0;
+    _lastByteTime = 0;
 }
 
 void BluetoothComm::begin(long baudRate) {
@@ -85,21 +86,239 @@ void BluetoothComm::configureModule() {
 }
 
 bool BluetoothComm::hasCommand() {
-    bool dataAvailable = false;
+    // Never block here: readString() would wait out the full Stream
+    // timeout (1s) after every command
+    _readAvailable();
     
-    if (_useHardwareSerial) {
-        dataAvailable = Serial.available() > 0;
-        if (dataAvailable) {
-            _commandBuffer += Serial.readString();
-        }
+    if (_commandBuffer.length() == 0) return false;
+    
+    // Complete on newline, on a closed packet, or once the line has gone
+    // quiet for apps that send bare commands without a terminator
+    return _commandBuffer.indexOf('\n') >= 0 || 
+           _isPacketComplete(_commandBuffer) ||
+           millis() - _lastByteTime >= COMMAND_IDLE_GAP_MS;
+}
+
+String BluetoothComm::readCommand() {
+    String command;
+    int lineEnd = _commandBuffer.indexOf('\n');
+    int packetEnd = _commandBuffer.indexOf('#');
+    
+    if (_commandBuffer.startsWith("!") && packetEnd >= 0 && 
+        (lineEnd < 0 || packetEnd < lineEnd)) {
+        // Packet frames carry their own terminator
+        command = _commandBuffer.substring(0, packetEnd + 1);
+        _commandBuffer.remove(0, packetEnd + 1);
+    } else if (lineEnd >= 0) {
+        command = _commandBuffer.substring(0, lineEnd);
+        _commandBuffer.remove(0, lineEnd + 1);
     } else {
-        dataAvailable = _bluetooth->available() > 0;
-        if (dataAvailable) {
-            _commandBuffer += _bluetooth->readString();
-        }
+        // Idle-gap framed command
+        command = _commandBuffer;
+        _commandBuffer = "";
+    }
+    
+    _lastCommandTime = millis();
+    return command;
+}
+
+bool BluetoothComm::parseCommand(String cmd, char &type, int &param1, int &param2) {
+    param1 = 0;
+    param2 = 0;
+    
+    if (cmd.startsWith("!")) {
+        return parsePacketProtocol(cmd, type, param1, param2);
+    }
+    
+    if (cmd.startsWith("M") && cmd.length() >= 7) {
+        type = CMD_MOTOR;
+        return parseDifferential(cmd, param1, param2);
+    }
+    
+    if (cmd.length() == 1) {
+        return parseSingleChar(cmd, type);
+    }
+    
+    return parseSpeedCommand(cmd, type, param1);
+}
+
+bool BluetoothComm::validateChecksum(String packet) {
+    // Format: !<length>[<seq>]<command><data><checksum>#
+    if (packet.length() < 7) return false;
+    if (!packet.startsWith("!") || !packet.endsWith("#")) return false;
+    
+    // Length counts everything between the delimiters
+    int length = packet.substring(1, 3).toInt();
+    if (length != (int)packet.length() - 2) return false;
+    
+    uint8_t received = packet.substring(packet.length() - 3, packet.length() - 1).toInt();
+    return calculateChecksum(packet.substring(1, packet.length() - 3)) == received;
+}
+
+// Protocol Support Methods
+bool BluetoothComm::parseSingleChar(String cmd, char &command) {
+    if (cmd.length() != 1) return false;
+    
+    command = cmd.charAt(0);
+    return isValidCommand(command);
+}
+
+bool BluetoothComm::parseSpeedCommand(String cmd, char &direction, int &speed) {
+    if (cmd.length() < 2) return false;
+    
+    direction = cmd.charAt(0);
+    if (direction != CMD_FORWARD && direction != CMD_BACKWARD && 
+        direction != CMD_LEFT && direction != CMD_RIGHT) {
+        return false;
     }
     
-    // Check for complete command
-    return _commandBuffer.length() > 0 && 
-           (_commandBuffer.indexOf('\n') >= 0 || _isPacketComplete(_commandBuffer));
+    speed = constrain(cmd.substring(1).toInt(), 0, 255);
+    return true;
+}
+
+bool BluetoothComm::parseDifferential(String cmd, int &leftSpeed, int &rightSpeed) {
+    // Format: M<axis1><axis2>, three digits each, centred on DIFFERENTIAL_CENTER
+    if (cmd.length() < 7) return false;
+    
+    leftSpeed = decodeAxis(cmd.substring(1, 4).toInt());
+    rightSpeed = decodeAxis(cmd.substring(4, 7).toInt());
+    return true;
+}
+
+int BluetoothComm::decodeAxis(int field) {
+    // Offset binary so one unsigned field covers both directions
+    int offset = constrain(field, 0, 2 * DIFFERENTIAL_CENTER) - DIFFERENTIAL_CENTER;
+    return (offset * 255) / DIFFERENTIAL_CENTER;
+}
+
+bool BluetoothComm::parsePacketProtocol(String cmd, char &type, int &param1, int &param2) {
+    int sequence;
+    String data;
+    if (!parsePacket(cmd, sequence, type, data)) return false;
+    
+    param1 = data.substring(0, 3).toInt();
+    param2 = data.substring(3, 6).toInt();
+    return isValidCommand(type);
+}
+
+bool BluetoothComm::parsePacket(String packet, int &sequence, char &type, String &data) {
+    if (!validateChecksum(packet)) return false;
+    
+    sequence = packetSequence(packet);
+    type = packet.charAt(_commandIndex(packet));
+    data = _extractPacketData(packet);
+    return true;
+}
+
+int BluetoothComm::packetSequence(String packet) {
+    // Sequenced packets carry two digits where the command letter would be
+    if (packet.length() < 9) return -1;
+    char high = packet.charAt(3);
+    char low = packet.charAt(4);
+    if (high < '0' || high > '9' || low < '0' || low > '9') return -1;
+    return (high - '0') * 10 + (low - '0');
+}
+
+// Response Methods
+void BluetoothComm::sendResponse(String response) {
+    _port()->println(response);
+}
+
+void BluetoothComm::sendStatus(String status) {
+    _port()->println("STATUS: " + status);
+}
+
+void BluetoothComm::sendError(String error) {
+    _port()->println("ERROR: " + error);
+}
+
+void BluetoothComm::sendAck(uint8_t sequence) {
+    // Four bytes: short enough that ACKing never stalls the loop
+    Stream* port = _port();
+    port->write('K');
+    port->write('0' + sequence / 10 % 10);
+    port->write('0' + sequence % 10);
+    port->write('\n');
+}
+
+// Utility Methods
+void BluetoothComm::clearBuffer() {
+    _flushInput();
+    _commandBuffer = "";
+}
+
+uint8_t BluetoothComm::calculateChecksum(String data) {
+    unsigned int sum = 0;
+    for (unsigned int i = 0; i < data.length(); i++) {
+        sum += (uint8_t)data.charAt(i);
+    }
+    return sum % 100;
+}
+
+bool BluetoothComm::isValidCommand(char cmd) {
+    switch (cmd) {
+        case CMD_FORWARD:
+        case CMD_BACKWARD:
+        case CMD_LEFT:
+        case CMD_RIGHT:
+        case CMD_STOP:
+        case CMD_WEAPON:
+        case CMD_MOTOR:
+        case CMD_DRIVE_MODE:
+        case CMD_EMERGENCY:
+        case CMD_STATUS:
+        case CMD_LINK_QUALITY:
+        case 'A':  // Attack
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool BluetoothComm::isCriticalCommand(char cmd) {
+    // Motion is fire-and-forget: the next packet supersedes a lost one
+    return cmd == CMD_WEAPON || cmd == CMD_EMERGENCY || cmd == CMD_DRIVE_MODE;
+}
+
+// Private Methods
+Stream* BluetoothComm::_port() {
+    if (_useHardwareSerial) return &Serial;
+    return _bluetooth;
+}
+
+void BluetoothComm::_readAvailable() {
+    Stream* port = _port();
+    
+    while (port->available() > 0) {
+        // Drop a runaway line rather than growing the heap without bound,
+        // but keep the complete commands queued ahead of it
+        if (_commandBuffer.length() >= COMMAND_BUFFER_SIZE) {
+            int complete = max(_commandBuffer.lastIndexOf('\n'), _commandBuffer.lastIndexOf('#')) + 1;
+            if (complete >= (int)_commandBuffer.length()) break;  // Let readCommand() drain it first
+            _commandBuffer.remove(complete);
+        }
+        _commandBuffer += (char)port->read();
+        _lastByteTime = millis();
+    }
+}
+
+void BluetoothComm::_flushInput() {
+    Stream* port = _port();
+    while (port->available() > 0) {
+        port->read();
+    }
+}
+
+bool BluetoothComm::_isPacketComplete(String buffer) {
+    return buffer.startsWith("!") && buffer.indexOf('#') > 0;
+}
+
+uint8_t BluetoothComm::_commandIndex(String packet) {
+    return packetSequence(packet) >= 0 ? 5 : 3;
+}
+
+String BluetoothComm::_extractPacketData(String packet) {
+    // Strip "!<length>[<seq>]<command>" and "<checksum>#"
+    if (packet.length() < 7) return "";
+    return packet.substring(_commandIndex(packet) + 1, packet.length() - 3);
 }
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "../include/DriveMixer.h"
+
+/*
+ * DriveMixer Implementation
+ * Integer-only mixing: 16x16 multiplies, shifts and at most two 16-bit
+ * divides (curvature blend, saturation), so it stays in the microsecond
+ * range on AVR
+ */
+
+#define DRIVE_MAX_GAIN  1024            // Q8 gain ceiling (4.0) keeps sums in 16 bits
+
+// Sign-magnitude Q8 multiply so +x and -x scale symmetrically
+static int16_t _scaleQ8(int16_t value, uint16_t gain) {
+    if (value < 0) {
+        return -(int16_t)(((uint32_t)(-value) * gain) >> 8);
+    }
+    return (int16_t)(((uint32_t)value * gain) >> 8);
+}
+
+// Curvature steering gain (Q8) for a throttle magnitude: 1.0 (spin in place)
+// below the quick-turn band, the throttle itself above it, and a linear
+// blend across the band so the turn rate never steps as the stick moves
+static uint16_t _curvatureGain(int16_t speed) {
+    const int16_t low = DRIVE_QUICKTURN_THRESHOLD > DRIVE_QUICKTURN_BAND / 2 ?
+                        DRIVE_QUICKTURN_THRESHOLD - DRIVE_QUICKTURN_BAND / 2 : 0;
+    const int16_t high = DRIVE_QUICKTURN_THRESHOLD + DRIVE_QUICKTURN_BAND / 2;
+    if (speed <= low) return 256;
+    if (speed >= high) return speed;
+
+    uint16_t weight = speed - low;
+    return (256 * (high - speed) + speed * weight) / (high - low);
+}
+
+DriveMixer::DriveMixer()
+    : _mode(DRIVE_MODE_DEFAULT), _differentialGain(DIFFERENTIAL_GAIN),
+      _turnRate(TURN_RATE_MULTIPLIER) {
+    setExpo(DRIVE_THROTTLE_EXPO, DRIVE_STEERING_EXPO);
+}
+
+// Configuration
+void DriveMixer::setMode(uint8_t mode) {
+    if (mode <= DRIVE_MODE_CURVATURE) {
+        _mode = mode;
+    }
+}
+
+uint8_t DriveMixer::getMode() const {
+    return _mode;
+}
+
+void DriveMixer::setExpo(uint8_t throttleExpo, uint8_t steeringExpo) {
+    _buildCurve(_throttleCurve, throttleExpo);
+    _buildCurve(_steeringCurve, steeringExpo);
+}
+
+void DriveMixer::setGains(uint16_t differentialGain, uint16_t turnRate) {
+    _differentialGain = min(differentialGain, (uint16_t)DRIVE_MAX_GAIN);
+    _turnRate = min(turnRate, (uint16_t)DRIVE_MAX_GAIN);
+}
+
+// Mixing
+void DriveMixer::mix(int16_t axis1, int16_t axis2, int16_t &left, int16_t &right) const {
+    axis1 = constrain(axis1, -255, 255);
+    axis2 = constrain(axis2, -255, 255);
+
+    int16_t throttle;
+    int16_t turn;
+
+    switch (_mode) {
+        case DRIVE_MODE_TANK: {
+            // Sides in; the differential gain scales the side difference
+            // around the mean (gain 1.0 passes the sides straight through)
+            int16_t leftIn = applyThrottleCurve(axis1);
+            int16_t rightIn = applyThrottleCurve(axis2);
+            int16_t sum = leftIn + rightIn;
+            int16_t difference = _scaleQ8(leftIn - rightIn, _differentialGain);
+            _saturate((sum + difference) / 2, (sum - difference) / 2, left, right);
+            return;
+        }
+        case DRIVE_MODE_ARCADE: {
+            // Steering sets the turn rate directly
+            throttle = applyThrottleCurve(axis1);
+            turn = _scaleQ8(applySteeringCurve(axis2), _turnRate);
+            break;
+        }
+        case DRIVE_MODE_CURVATURE: {
+            // Steering sets the turn radius: turn rate follows speed.
+            // Near zero throttle it blends into spinning in place.
+            throttle = applyThrottleCurve(axis1);
+            int16_t curvature = _scaleQ8(applySteeringCurve(axis2), _curvatureGain(abs(throttle)));
+            turn = _scaleQ8(curvature, _turnRate);
+            break;
+        }
+        default:
+            left = 0;
+            right = 0;
+            return;
+    }
+
+    turn = _scaleQ8(turn, _differentialGain);
+    _saturate(throttle + turn, throttle - turn, left, right);
+}
+
+// Response Curves
+int16_t DriveMixer::applyThrottleCurve(int16_t value) const {
+    return _lookup(_throttleCurve, value);
+}
+
+int16_t DriveMixer::applySteeringCurve(int16_t value) const {
+    return _lookup(_steeringCurve, value);
+}
+
+// Private Methods
+void DriveMixer::_buildCurve(uint16_t* curve, uint8_t expoPercent) {
+    // y = (1 - e) * x + e * x^3 / 255^2, so x = 255 maps to 255.
+    // Knots are kept in Q4 so interpolation does not lose the endpoint.
+    // Runs only when the expo changes, so the 32-bit divide is fine here.
+    uint32_t expo = min(expoPercent, (uint8_t)100);
+
+    for (uint8_t i = 0; i < DRIVE_EXPO_POINTS; i++) {
+        uint32_t x = (uint32_t)i * 16;
+        uint32_t linear = x * (100 - expo) * 16 / 100;
+        uint32_t cubic = (x * x * x / 255) * expo * 16 / (255UL * 100UL);
+        curve[i] = (uint16_t)(linear + cubic);
+    }
+}
+
+int16_t DriveMixer::_lookup(const uint16_t* curve, int16_t value) {
+    bool negative = value < 0;
+    uint8_t x = (uint8_t)min(abs(value), 255);
+
+    // Linear interpolation between Q4 knots 16 counts apart, then round
+    uint8_t index = x >> 4;
+    uint8_t fraction = x & 0x0F;
+    uint16_t y = curve[index] + (((curve[index + 1] - curve[index]) * fraction) >> 4);
+    y = (y + 8) >> 4;
+    if (y > 255) y = 255;
+
+    return negative ? -(int16_t)y : (int16_t)y;
+}
+
+void DriveMixer::_saturate(int16_t left, int16_t right, int16_t &outLeft, int16_t &outRight) {
+    uint16_t peak = max(abs(left), abs(right));
+
+    if (peak > 255) {
+        // Scale both sides by the same Q8 factor: the faster side lands on
+        // full speed and the turn ratio is kept
+        uint16_t scale = 65280U / peak + 1;
+        left = _scaleQ8(left, scale);
+        right = _scaleQ8(right, scale);
+    }
+
+    outLeft = constrain(left, -255, 255);
+    outRight = constrain(right, -255, 255);
+}
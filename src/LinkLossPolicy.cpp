@@ -0,0 +1,143 @@
+#include "../include/LinkLossPolicy.h"
+
+/*
+ * LinkLossPolicy Implementation
+ * All timing runs off millis(), so the slew rates hold whatever the loop
+ * period is. Integer only: the slew budget keeps its remainder between
+ * passes instead of rounding it away.
+ */
+
+LinkLossPolicy::LinkLossPolicy()
+    : _holdMs(LINK_HOLD_MS), _stopMs(RADIO_TIMEOUT),
+      _rampRate(LINK_RAMP_RATE), _decayRate(LINK_DECAY_RATE),
+      _followRamp(LINK_HOLD_FOLLOW_RAMP),
+      _targetLeft(0), _targetRight(0), _outputLeft(0), _outputRight(0),
+      _changed(false), _tier(LINK_TIER_HOLD),
+      _lastCommandTime(0), _lastUpdateTime(0), _slewCredit(0) {
+}
+
+void LinkLossPolicy::begin() {
+    _targetLeft = 0;
+    _targetRight = 0;
+    _outputLeft = 0;
+    _outputRight = 0;
+    _changed = false;
+    _tier = LINK_TIER_HOLD;
+    _lastCommandTime = millis();
+    _lastUpdateTime = _lastCommandTime;
+    _slewCredit = 0;
+}
+
+void LinkLossPolicy::configure(unsigned long holdMs, unsigned long stopMs,
+                               uint16_t rampRate, uint16_t decayRate, bool followRamp) {
+    _stopMs = stopMs;
+    _holdMs = min(holdMs, stopMs);
+    _rampRate = max(rampRate, (uint16_t)1);
+    _decayRate = max(decayRate, (uint16_t)1);
+    _followRamp = followRamp;
+}
+
+// Events
+void LinkLossPolicy::linkAlive() {
+    // Back from a decay or stop: hold what the motors are doing now rather
+    // than jump back to a command that is already stale
+    if (_tier != LINK_TIER_HOLD) {
+        _targetLeft = _outputLeft;
+        _targetRight = _outputRight;
+        _tier = LINK_TIER_HOLD;
+    }
+    _lastCommandTime = millis();
+}
+
+void LinkLossPolicy::command(int16_t left, int16_t right) {
+    _targetLeft = constrain(left, -255, 255);
+    _targetRight = constrain(right, -255, 255);
+
+    // Without ramping the command applies at once and the hold freezes it
+    if (!_followRamp) {
+        _outputLeft = _targetLeft;
+        _outputRight = _targetRight;
+    }
+    _changed = true;
+}
+
+void LinkLossPolicy::stop() {
+    _targetLeft = 0;
+    _targetRight = 0;
+    _outputLeft = 0;
+    _outputRight = 0;
+    _changed = true;
+}
+
+bool LinkLossPolicy::update(int16_t &left, int16_t &right) {
+    unsigned long now = millis();
+    unsigned long elapsed = now - _lastUpdateTime;
+    _lastUpdateTime = now;
+    unsigned long quiet = now - _lastCommandTime;
+
+    int16_t previousLeft = _outputLeft;
+    int16_t previousRight = _outputRight;
+
+    if (quiet >= _stopMs) {
+        // Tier 3: hard stop
+        _tier = LINK_TIER_STOP;
+        _outputLeft = 0;
+        _outputRight = 0;
+        _slewCredit = 0;
+    } else if (quiet >= _holdMs) {
+        // Tier 2: decay through the slew limiter
+        if (_tier == LINK_TIER_HOLD) _slewCredit = 0;
+        _tier = LINK_TIER_DECAY;
+        int16_t step = _slewBudget(_decayRate, elapsed);
+        _outputLeft = _slew(_outputLeft, 0, step);
+        _outputRight = _slew(_outputRight, 0, step);
+    } else {
+        // Tier 1: hold, finishing any ramp that was in flight
+        _tier = LINK_TIER_HOLD;
+        if (_followRamp) {
+            int16_t step = _slewBudget(_rampRate, elapsed);
+            _outputLeft = _slew(_outputLeft, _targetLeft, step);
+            _outputRight = _slew(_outputRight, _targetRight, step);
+        }
+    }
+
+    left = _outputLeft;
+    right = _outputRight;
+
+    bool changed = _changed || _outputLeft != previousLeft || _outputRight != previousRight;
+    _changed = false;
+    return changed;
+}
+
+// Status
+uint8_t LinkLossPolicy::getTier() {
+    return _tier;
+}
+
+unsigned long LinkLossPolicy::getQuietTime() {
+    return millis() - _lastCommandTime;
+}
+
+const char* LinkLossPolicy::getTierString() {
+    switch (_tier) {
+        case LINK_TIER_HOLD:  return "HOLD";
+        case LINK_TIER_DECAY: return "DECAY";
+        default:              return "STOP";
+    }
+}
+
+// Private Methods
+int16_t LinkLossPolicy::_slewBudget(uint16_t rate, unsigned long elapsed) {
+    // rate * elapsed / 1000 with the remainder carried to the next pass;
+    // elapsed is capped so a long stall cannot overflow the credit
+    _slewCredit += (uint32_t)rate * min(elapsed, 1000UL);
+    uint32_t step = _slewCredit / 1000;
+    _slewCredit -= step * 1000;
+    return (int16_t)min(step, (uint32_t)510);
+}
+
+int16_t LinkLossPolicy::_slew(int16_t value, int16_t target, int16_t maxStep) {
+    if (value < target) return min((int16_t)(value + maxStep), target);
+    if (value > target) return max((int16_t)(value - maxStep), target);
+    return value;
+}
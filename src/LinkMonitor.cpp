@@ -0,0 +1,205 @@
+#include "../include/LinkMonitor.h"
+
+/*
+ * LinkMonitor Implementation
+ * Sequence numbers wrap at LINK_SEQ_MODULO; anything up to half the
+ * range ahead counts as newer. A bitmap of the last LINK_SEQ_WINDOW
+ * sequences separates late first copies from duplicates. After
+ * LINK_RESYNC_MS of silence the next packet starts a fresh window, so a
+ * controller that comes back at a far-off sequence is not locked out.
+ */
+
+#define LINK_NO_SIGNAL  0               // No RSSI report yet
+
+LinkMonitor::LinkMonitor() {
+    reset();
+}
+
+void LinkMonitor::reset() {
+    _started = false;
+    _lastPacket = 0;
+    _highest = 0;
+    _window = 0;
+    _received = 0;
+    _lost = 0;
+    _reordered = 0;
+    _duplicates = 0;
+    _lossAverage = 0;
+    _jitterQ4 = 0;
+    _lastArrival = 0;
+    _lastInterval = 0;
+    _retrySequence = 0;
+    _retries = 0;
+    _signalStrength = LINK_NO_SIGNAL;
+    _burstActive = false;
+    _burstTime = 0;
+}
+
+// Packet tracking
+uint8_t LinkMonitor::onPacket(uint8_t sequence, bool critical) {
+    sequence %= LINK_SEQ_MODULO;
+    unsigned long now = millis();
+    unsigned long quiet = now - _lastPacket;
+    _lastPacket = now;
+
+    if (!_started || quiet >= LINK_RESYNC_MS) {
+        // First packet, or the first after a dropout: whatever the
+        // controller sent meanwhile is unknown, so start from here
+        _started = true;
+        _highest = sequence;
+        _window = 1;
+        _received++;
+        _lastArrival = now;
+        _lastInterval = 0;
+        return LINK_NEW;
+    }
+
+    uint8_t ahead = (sequence + LINK_SEQ_MODULO - _highest) % LINK_SEQ_MODULO;
+
+    if (ahead > 0 && ahead < LINK_SEQ_MODULO / 2) {
+        // Newer: everything skipped is lost until it turns up late
+        uint8_t gap = ahead - 1;
+        _lost += gap;
+        _recordLoss(gap);
+        if (gap >= PACKET_LOSS_THRESHOLD) _flagBurst();
+
+        _window = ahead < LINK_SEQ_WINDOW ? (_window << ahead) | 1 : 1;
+        _highest = sequence;
+        _received++;
+        _recordArrival(ahead);
+        return LINK_NEW;
+    }
+
+    uint8_t behind = (LINK_SEQ_MODULO - ahead) % LINK_SEQ_MODULO;
+    if (behind >= LINK_SEQ_WINDOW) {
+        // Outside the bitmap: cannot tell, so count it with the duplicates.
+        // The caller still runs a critical command rather than drop it.
+        _duplicates++;
+        return LINK_STALE;
+    }
+
+    uint32_t bit = 1UL << behind;
+    if (_window & bit) {
+        _duplicates++;
+
+        // The controller resends critical packets until ACKed: repeats
+        // mean our ACKs are not getting back
+        if (critical) {
+            if (sequence != _retrySequence) {
+                _retrySequence = sequence;
+                _retries = 0;
+            }
+            if (++_retries >= BLUETOOTH_RETRY_COUNT) _flagBurst();
+        }
+        return LINK_DUPLICATE;
+    }
+
+    // First copy of a packet already counted as lost
+    _window |= bit;
+    _received++;
+    if (_lost > 0) _lost--;
+    _reordered++;
+    return LINK_LATE;
+}
+
+void LinkMonitor::updateSignalStrength(int rssi) {
+    _signalStrength = rssi;
+}
+
+// Link status
+bool LinkMonitor::isDegraded() {
+    if (_burstActive && millis() - _burstTime >= LINK_DEGRADED_HOLD_MS) {
+        _burstActive = false;
+    }
+
+    return _burstActive ||
+           getLossPercent() >= LINK_LOSS_LIMIT_PERCENT ||
+           (_signalStrength != LINK_NO_SIGNAL && _signalStrength < SIGNAL_STRENGTH_THRESHOLD);
+}
+
+unsigned long LinkMonitor::getReceived() {
+    return _received;
+}
+
+unsigned long LinkMonitor::getLost() {
+    return _lost;
+}
+
+unsigned long LinkMonitor::getReordered() {
+    return _reordered;
+}
+
+unsigned long LinkMonitor::getDuplicates() {
+    return _duplicates;
+}
+
+uint8_t LinkMonitor::getLossPercent() {
+    return _lossAverage >> 8;
+}
+
+uint16_t LinkMonitor::getJitterMs() {
+    return _jitterQ4 >> 4;
+}
+
+int LinkMonitor::getSignalStrength() {
+    return _signalStrength;
+}
+
+// Status and Diagnostics
+String LinkMonitor::getStatusString() {
+    String status = isDegraded() ? "LINK_DEGRADED" : "LINK_OK";
+
+    status += " rx=";
+    status += String(_received);
+    status += " loss=";
+    status += String(_percentOf(_lost));
+    status += "% reord=";
+    status += String(_percentOf(_reordered));
+    status += "% dup=";
+    status += String(_percentOf(_duplicates));
+    status += "% jit=";
+    status += String(getJitterMs());
+    status += "ms";
+    if (_signalStrength != LINK_NO_SIGNAL) {
+        status += " rssi=";
+        status += String(_signalStrength);
+    }
+    return status;
+}
+
+// Private Methods
+void LinkMonitor::_recordLoss(uint8_t count) {
+    // Moving average over ~16 packets: one update per expected packet,
+    // lost ones pull towards 100%, the arriving one towards 0%
+    for (uint8_t i = 0; i < count; i++) {
+        _lossAverage = _lossAverage - (_lossAverage >> 4) + ((100U << 8) >> 4);
+    }
+    _lossAverage -= _lossAverage >> 4;
+}
+
+void LinkMonitor::_recordArrival(uint8_t steps) {
+    unsigned long now = millis();
+
+    // RFC 3550 style jitter, J += (|D| - J) / 16, on the per-packet interval
+    // so a gap is not mistaken for jitter
+    unsigned long interval = (now - _lastArrival) / steps;
+    if (_lastInterval > 0) {
+        unsigned long change = interval > _lastInterval ? interval - _lastInterval
+                                                        : _lastInterval - interval;
+        change = min(change, 4095UL);   // Keeps the Q4 sum in 16 bits
+        _jitterQ4 = _jitterQ4 + change - (_jitterQ4 >> 4);
+    }
+    _lastInterval = interval;
+    _lastArrival = now;
+}
+
+void LinkMonitor::_flagBurst() {
+    _burstActive = true;
+    _burstTime = millis();
+}
+
+uint8_t LinkMonitor::_percentOf(unsigned long count) {
+    unsigned long expected = _received + _lost;
+    if (expected == 0) return 0;
+    return min((count * 100UL) / expected, 100UL);
+}
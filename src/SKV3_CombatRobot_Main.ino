@@ -15,34 +15,123 @@
  */
 
 #include <SoftwareSerial.h>
+#include <avr/wdt.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
 
-// Pin Definitions - SKV Shield Standard Configuration
-#define MOTOR_LEFT_PWM    9   // ENA - Left motor PWM
-#define MOTOR_LEFT_DIR1   8   // IN1 - Left motor direction
-#define MOTOR_LEFT_DIR2   7   // IN2 - Left motor direction
-#define MOTOR_RIGHT_PWM   10  // ENB - Right motor PWM  
-#define MOTOR_RIGHT_DIR1  6   // IN3 - Right motor direction
-#define MOTOR_RIGHT_DIR2  5   // IN4 - Right motor direction
-#define WEAPON_PIN        3   // Weapon control pin
-#define LED_STATUS        13  // Status LED
-#define EMERGENCY_STOP    2   // Hardware emergency stop (interrupt pin)
-
-// Bluetooth Communication
-#define BT_RX             4   // Bluetooth RX pin
-#define BT_TX             12  // Bluetooth TX pin
-SoftwareSerial bluetooth(BT_RX, BT_TX);
-
-// Combat Robot Performance Constants
-#define WORM_MOTOR_DEADBAND   80    // Minimum PWM for worm motor movement
-#define MAX_MOTOR_SPEED       255   // Maximum PWM value
-#define SAFETY_TIMEOUT_MS     500   // Competition standard 500ms timeout
-#define RESPONSE_TARGET_MS    50    // Target response time under 50ms
+// Pins, timing, tuning and feature switches: config/SKV3_Config.h
+#include "config/SKV3_Config.h"
+
+// Black-box records, slots and dump lines: shared with tools/blackbox_dump
+#include "include/BlackBoxFormat.h"
+
+SoftwareSerial bluetooth(BT_RX_PIN, BT_TX_PIN);
+
+// Drive Mixer - integer only, gains in Q8 (256 = 1.0)
+#define DRIVE_MODE_TANK       0     // M<left><right>
+#define DRIVE_MODE_ARCADE     1     // M<throttle><steering>
+#define DRIVE_MODE_CURVATURE  2     // M<throttle><curvature>
+#define DRIVE_EXPO_POINTS     17    // LUT knots every 16 counts
+
+// Link Quality - sequenced packets "!<len><seq><cmd><data><checksum>#"
+#define LINK_NEW              0     // Newest so far: execute
+#define LINK_LATE             1     // Older, first copy: execute only if critical
+#define LINK_DUPLICATE        2     // Seen before: drop, re-ACK if critical
+#define LINK_STALE            3     // Too old to tell: execute only if critical
+
+// Hardware Watchdog - fed only while every task heartbeat is on time
+#define ENABLE_WATCHDOG       true
+#define WATCHDOG_PERIOD       WDTO_500MS  // Interrupt cuts outputs, reset one period later
+#define HEARTBEAT_TIMEOUT_MS  100   // Max gap between task heartbeats
+#define WATCHDOG_RECORD_MAGIC 0x5744
+#define TASK_LOOP             0
+#define TASK_COMMS            1
+#define TASK_COUNT            2
+
+// Black-Box Recorder - delta records in a RAM ring, copied to EEPROM only on
+// events, in the layout tools/blackbox_dump decodes ("LOG" on the USB port
+// downloads it). Battery is not measured on SKV3: always 0.
+#define BLACKBOX_RING_MAGIC   0xB10C
+#define BLACKBOX_SLOT_BYTES   (BLACKBOX_SLOT_HEADER_BYTES + BLACKBOX_RING_BYTES)
 
 // Safety and Control Variables
 unsigned long lastCommandTime = 0;
 bool emergencyStop = false;
 bool weaponEnabled = false;
 volatile bool hardwareEmergencyStop = false;
+volatile bool rearmPending = false;
+unsigned long rearmStartTime = 0;
+
+// Watchdog state
+unsigned long taskHeartbeat[TASK_COUNT];
+volatile bool watchdogTripped = false;
+int weaponBlinksLeft = 0;
+
+// Drive mixer state
+uint8_t driveMode = DRIVE_MODE_DEFAULT;
+uint16_t throttleCurve[DRIVE_EXPO_POINTS];
+uint16_t steeringCurve[DRIVE_EXPO_POINTS];
+
+// Link quality state
+struct LinkStats {
+  bool started;
+  unsigned long lastPacket;     // Any verdict; a long silence resyncs
+  uint8_t highest;              // Newest sequence received
+  uint32_t window;              // Bit n set: (highest - n) received
+  unsigned long received, lost, reordered, duplicates;
+  uint16_t lossAverage;         // Recent loss, percent in Q8
+  uint16_t jitterQ4;            // Inter-arrival jitter in ms, Q4
+  unsigned long lastArrival, lastInterval;
+  uint8_t retrySequence, retries;
+  int signalStrength;           // dBm from the controller, 0 = no report
+  bool burstActive;
+  unsigned long burstTime;
+};
+LinkStats linkStats;
+
+// Link-loss state - hold, decay, then the safety timeout stops
+struct LinkLoss {
+  int holdLeft, holdRight;      // Last commanded speeds
+  bool decaying;
+  int decayLeft, decayRight;    // Speeds on the way down
+  unsigned long lastUpdate;
+  uint32_t slewCredit;          // Fractional decay carried between passes (x1000)
+};
+LinkLoss linkLoss;
+
+// Survives the watchdog reset (Optiboot clears MCUSR, so record it ourselves)
+struct WatchdogRecord {
+  uint16_t magic;
+  uint8_t staleTasks;
+};
+WatchdogRecord watchdogRecord __attribute__((section(".noinit")));
+
+// Black-box recorder state
+struct BlackBoxState {
+  unsigned long lastSample;
+  int lastLeft, lastRight;
+  uint8_t lastSafety;
+  char command;                 // Last command letter this sample, 0 = none
+  uint8_t pendingEvent;
+  uint8_t sinceKeyframe;
+  bool forceKeyframe;
+  int idleRun;                  // Ring index of the open idle run, -1 = none
+  bool committing;
+  uint8_t commitSlot, commitReason, commitSum;
+  uint16_t commitStep, commitLength, commitTail;
+  uint16_t sequence;            // Of the newest committed slot
+  bool dumping;
+  uint8_t dumpPhase;
+  uint16_t dumpOffset;
+};
+BlackBoxState blackBox;
+
+// The ring itself survives the watchdog reset too
+struct BlackBoxRing {
+  uint16_t magic, head, used, check;
+  uint8_t data[BLACKBOX_RING_BYTES];
+};
+BlackBoxRing blackBoxRing __attribute__((section(".noinit")));
 
 // Motor Control Class - Professional Implementation
 class WormMotorController {
@@ -94,6 +183,9 @@ public:
     }
   }
   
+  int getSpeed() { return currentSpeed; }
+  bool isSettled() { return currentSpeed == targetSpeed; }
+  
   void stop() {
     digitalWrite(dir1Pin, LOW);
     digitalWrite(dir2Pin, LOW);
@@ -121,6 +213,20 @@ void setup() {
   Serial.begin(115200);  // High-speed serial for debugging
   bluetooth.begin(9600); // Standard HC-05 baud rate
   
+  // Report why we restarted - a watchdog reset means something hung
+  uint8_t resetFlags = MCUSR;
+  if (watchdogRecord.magic == WATCHDOG_RECORD_MAGIC) resetFlags |= _BV(WDRF);
+  reportResetCause();
+  
+  // Whatever led up to a watchdog reset is still in the black-box ring
+  #if ENABLE_BLACKBOX
+  blackBoxBegin(resetFlags);
+  #endif
+  
+  // Response curves for the drive mixer (integer, built once)
+  buildExpoCurve(throttleCurve, DRIVE_THROTTLE_EXPO);
+  buildExpoCurve(steeringCurve, DRIVE_STEERING_EXPO);
+  
   // PWM frequency optimization for smoother motor control
   // Change PWM frequency from 490Hz to 3.9kHz for pins 9 and 10
   TCCR1B = (TCCR1B & 0xF8) | 0x02;
@@ -129,43 +235,77 @@ void setup() {
   
   // Initialize pins
   pinMode(WEAPON_PIN, OUTPUT);
-  pinMode(LED_STATUS, OUTPUT);
-  pinMode(EMERGENCY_STOP, INPUT_PULLUP);
+  pinMode(LED_STATUS_PIN, OUTPUT);
+  pinMode(EMERGENCY_STOP_PIN, INPUT_PULLUP);
   
   // Hardware interrupt for emergency stop - Competition requirement
-  attachInterrupt(digitalPinToInterrupt(EMERGENCY_STOP), hardwareEmergencyISR, FALLING);
+  attachInterrupt(digitalPinToInterrupt(EMERGENCY_STOP_PIN), hardwareEmergencyISR, FALLING);
   
   // Initialize safety state
   emergencyStop = false;
   weaponEnabled = false;
   digitalWrite(WEAPON_PIN, LOW);
-  digitalWrite(LED_STATUS, HIGH); // Power on indicator
+  digitalWrite(LED_STATUS_PIN, HIGH); // Power on indicator
   
   // Initial motor test sequence (optional)
   testMotorSystems();
   
+  // Arm the watchdog last so the motor test cannot trip it
+  #if ENABLE_WATCHDOG
+  enableWatchdog();
+  #endif
+  
   Serial.println("SKV3 Combat Robot - Professional Control System Ready");
   Serial.println("Safety protocols active - Competition grade");
 }
 // Main program loop - Optimized for sub-50ms response times
 void loop() {
-  // Check for hardware emergency stop
-  if (hardwareEmergencyStop) {
+  // Feed the watchdog only if every task checked in on time
+  serviceWatchdog();
+  heartbeat(TASK_LOOP);
+  
+  // Hardware emergency stop - the ISR has already cut the outputs. The
+  // level check backs up the edge-triggered interrupt: a held button
+  // always trips, whatever the flags say
+  if (digitalRead(EMERGENCY_STOP_PIN) == LOW) {
+    hardwareEmergencyStop = true;
+  }
+  if (hardwareEmergencyStop && !emergencyStop) {
     executeEmergencyShutdown();
-    return;
   }
   
-  // Safety timeout check - Competition requirement (500ms max)
-  unsigned long currentTime = millis();
-  if (currentTime - lastCommandTime > SAFETY_TIMEOUT_MS) {
-    executeSafetyTimeout();
+  // Recording carries on through an e-stop or a timeout
+  #if ENABLE_BLACKBOX
+  serviceBlackBox();
+  #endif
+  
+  // Emergency state is serviced one pass at a time, never in a wait loop
+  if (emergencyStop) {
+    serviceEmergencyStop();
     return;
   }
   
   // Process Bluetooth commands - High priority
-  if (bluetooth.available()) {
-    processBluetoothCommand();
+  // Polled before the timeout check so a lost link can recover
+  unsigned long currentTime = millis();
+  String command;
+  if (readBluetoothCommand(command)) {
     lastCommandTime = currentTime;
+    processBluetoothCommand(command);
+  }
+  heartbeat(TASK_COMMS);
+  
+  // A lossy link is not trusted with the weapon
+  if (weaponEnabled && linkDegraded()) {
+    weaponEnabled = false;
+    digitalWrite(WEAPON_PIN, LOW);
+    Serial.println("WEAPON OFF - LINK DEGRADED");
+  }
+  
+  // Safety timeout check - Competition requirement (500ms max)
+  if (currentTime - lastCommandTime > SAFETY_TIMEOUT_MS) {
+    executeSafetyTimeout();
+    return;
   }
   
   // Update motor control systems
@@ -177,12 +317,53 @@ void loop() {
   // Keep loop fast - no delay() functions used
 }
 
+// Non-blocking command framing - never waits on the serial port
+// A command ends at a newline, at the closing '#' of a packet, or after
+// COMMAND_IDLE_GAP_MS of silence for apps that send bare characters.
+// (readString() would stall the loop for its full 1s timeout instead.)
+bool readBluetoothCommand(String &command) {
+  static String lineBuffer;
+  static unsigned long lastByteTime = 0;
+  
+  while (bluetooth.available()) {
+    char c = bluetooth.read();
+    lastByteTime = millis();
+    
+    if (c == '\n' || c == '\r') {
+      if (lineBuffer.length() == 0) continue;
+      command = lineBuffer;
+      lineBuffer = "";
+      return true;
+    }
+    
+    // Drop a runaway line rather than growing the heap without bound
+    if (lineBuffer.length() >= COMMAND_BUFFER_SIZE) {
+      lineBuffer = "";
+    }
+    lineBuffer += c;
+    
+    if (c == '#' && lineBuffer.startsWith("!")) {
+      command = lineBuffer;
+      lineBuffer = "";
+      return true;
+    }
+  }
+  
+  if (lineBuffer.length() > 0 && millis() - lastByteTime >= COMMAND_IDLE_GAP_MS) {
+    command = lineBuffer;
+    lineBuffer = "";
+    return true;
+  }
+  
+  return false;
+}
+
 // Professional command processing - Multiple protocol support
-void processBluetoothCommand() {
-  String command = bluetooth.readString();
+void processBluetoothCommand(String command) {
   command.trim(); // Remove whitespace
   
   if (command.length() == 0) return;
+  blackBox.command = command.charAt(0);
   
   // Emergency stop command - Highest priority
   if (command == "STOP" || command == "E" || command == "!") {
@@ -194,6 +375,13 @@ void processBluetoothCommand() {
   if (command.length() == 1) {
     // Single character commands - Fast parsing
     processSingleCharCommand(command.charAt(0));
+  } else if (command.length() == 2 && command.charAt(0) == 'D') {
+    // Drive mode: D0 tank, D1 arcade, D2 curvature
+    setDriveMode(command.charAt(1) - '0');
+  } else if (command == "END") {
+    // Match over: log it and save the black box
+    blackBoxEvent(BLACKBOX_EVENT_MATCH_END);
+    bluetooth.println("MATCH END LOGGED");
   } else if (command.length() >= 4) {
     // Multi-parameter commands - Advanced control
     processAdvancedCommand(command);
@@ -227,6 +415,9 @@ void processSingleCharCommand(char cmd) {
     case 'A': case 'a':  // Attack (move forward fast)
       attackMove();
       break;
+    case '?':  // Link status to the controller
+      reportLinkStatus();
+      break;
     default:
       // Unknown command - ignore for safety
       break;
@@ -235,13 +426,11 @@ void processSingleCharCommand(char cmd) {
 
 // Advanced command processing - Professional implementations
 void processAdvancedCommand(String cmd) {
-  // Format: "M150200" = Move with left=150, right=200
+  // Format: "M254127" = two axes, 000-254 with 127 = stop
+  // Arcade/curvature read throttle/steering, tank reads left/right
   if (cmd.startsWith("M") && cmd.length() == 7) {
-    int leftSpeed = cmd.substring(1, 4).toInt();
-    int rightSpeed = cmd.substring(4, 7).toInt();
-    
-    // Apply differential drive control
-    setDifferentialDrive(leftSpeed - 127, rightSpeed - 127);
+    setDifferentialDrive(decodeAxis(cmd.substring(1, 4).toInt()),
+                         decodeAxis(cmd.substring(4, 7).toInt()));
     return;
   }
   
@@ -259,7 +448,7 @@ void processAdvancedCommand(String cmd) {
   }
   
   // Packet-based protocol with error detection
-  // Format: "!05M15020099#"
+  // Format: "!11M15020071#"
   if (cmd.startsWith("!") && cmd.endsWith("#")) {
     processPacketCommand(cmd);
     return;
@@ -293,21 +482,106 @@ void attackMove() {
   setBothMotors(255, 255);
 }
 
-// Differential drive implementation - Expert algorithm
-void setDifferentialDrive(int throttle, int steering) {
-  // Professional differential drive math
-  int leftSpeed = throttle + steering;
-  int rightSpeed = throttle - steering;
+// Differential drive implementation - mixed in the current drive mode
+void setDifferentialDrive(int axis1, int axis2) {
+  int leftSpeed, rightSpeed;
+  mixDrive(axis1, axis2, leftSpeed, rightSpeed);
+  setBothMotors(leftSpeed, rightSpeed);
+}
+
+void setDriveMode(int mode) {
+  if (mode < DRIVE_MODE_TANK || mode > DRIVE_MODE_CURVATURE) return;
+  driveMode = mode;
+  stopMovement();  // Axes mean something else now
+}
+
+// M field decode - offset binary so one unsigned field covers both directions
+int decodeAxis(int field) {
+  int offset = constrain(field, 0, 2 * DIFFERENTIAL_CENTER) - DIFFERENTIAL_CENTER;
+  return (offset * 255) / DIFFERENTIAL_CENTER;
+}
+
+// Drive mixer - integer only: 16x16 multiplies, shifts and at most two
+// 16-bit divides, so a mix costs microseconds
+int scaleQ8(int value, unsigned int gain) {
+  // Sign-magnitude so +x and -x scale symmetrically
+  if (value < 0) {
+    return -(int)(((unsigned long)(-value) * gain) >> 8);
+  }
+  return (int)(((unsigned long)value * gain) >> 8);
+}
+
+// Curvature steering gain (Q8): spin in place below the quick-turn band,
+// follow the throttle above it, blend linearly across it
+unsigned int curvatureGain(int speed) {
+  const int low = DRIVE_QUICKTURN_THRESHOLD > DRIVE_QUICKTURN_BAND / 2 ?
+                  DRIVE_QUICKTURN_THRESHOLD - DRIVE_QUICKTURN_BAND / 2 : 0;
+  const int high = DRIVE_QUICKTURN_THRESHOLD + DRIVE_QUICKTURN_BAND / 2;
+  if (speed <= low) return 256;
+  if (speed >= high) return speed;
+  return (256U * (high - speed) + (unsigned int)speed * (speed - low)) / (high - low);
+}
+
+void buildExpoCurve(uint16_t *curve, uint8_t expoPercent) {
+  // y = (1 - e) * x + e * x^3 / 255^2, knots in Q4 so x = 255 maps to 255
+  unsigned long expo = min(expoPercent, (uint8_t)100);
+  for (uint8_t i = 0; i < DRIVE_EXPO_POINTS; i++) {
+    unsigned long x = (unsigned long)i * 16;
+    curve[i] = x * (100 - expo) * 16 / 100 + (x * x * x / 255) * expo * 16 / (255UL * 100UL);
+  }
+}
+
+int applyCurve(const uint16_t *curve, int value) {
+  // Linear interpolation between Q4 LUT knots 16 counts apart, then round
+  uint8_t x = min(abs(value), 255);
+  uint8_t index = x >> 4;
+  uint16_t y = curve[index] + (((curve[index + 1] - curve[index]) * (x & 0x0F)) >> 4);
+  y = (y + 8) >> 4;
+  if (y > 255) y = 255;
+  return value < 0 ? -(int)y : (int)y;
+}
+
+void mixDrive(int axis1, int axis2, int &leftSpeed, int &rightSpeed) {
+  axis1 = constrain(axis1, -255, 255);
+  axis2 = constrain(axis2, -255, 255);
+  int throttle, turn;
+  
+  if (driveMode == DRIVE_MODE_TANK) {
+    // Differential gain scales the side difference around the mean
+    int left = applyCurve(throttleCurve, axis1);
+    int right = applyCurve(throttleCurve, axis2);
+    int difference = scaleQ8(left - right, DIFFERENTIAL_GAIN);
+    leftSpeed = (left + right + difference) / 2;
+    rightSpeed = (left + right - difference) / 2;
+  } else {
+    throttle = applyCurve(throttleCurve, axis1);
+    turn = applyCurve(steeringCurve, axis2);
+    
+    // Curvature: turn rate follows speed, spin in place near standstill
+    if (driveMode == DRIVE_MODE_CURVATURE) {
+      turn = scaleQ8(turn, curvatureGain(abs(throttle)));
+    }
+    turn = scaleQ8(scaleQ8(turn, TURN_RATE_MULTIPLIER), DIFFERENTIAL_GAIN);
+    leftSpeed = throttle + turn;
+    rightSpeed = throttle - turn;
+  }
   
-  // Constrain to valid PWM range
+  // Saturate both sides by the same factor so the turn ratio is kept
+  unsigned int peak = max(abs(leftSpeed), abs(rightSpeed));
+  if (peak > 255) {
+    unsigned int scale = 65280U / peak + 1;
+    leftSpeed = scaleQ8(leftSpeed, scale);
+    rightSpeed = scaleQ8(rightSpeed, scale);
+  }
   leftSpeed = constrain(leftSpeed, -255, 255);
   rightSpeed = constrain(rightSpeed, -255, 255);
-  
-  setBothMotors(leftSpeed, rightSpeed);
 }
 
 void setBothMotors(int leftSpeed, int rightSpeed) {
   if (!emergencyStop && !hardwareEmergencyStop) {
+    linkLoss.holdLeft = leftSpeed;
+    linkLoss.holdRight = rightSpeed;
+    linkLoss.decaying = false;
     leftMotor.setSpeed(leftSpeed);
     rightMotor.setSpeed(rightSpeed);
   }
@@ -315,58 +589,96 @@ void setBothMotors(int leftSpeed, int rightSpeed) {
 
 // Weapon control - Competition safety protocols
 void toggleWeapon() {
-  if (!emergencyStop && !hardwareEmergencyStop) {
+  if (!emergencyStop && !hardwareEmergencyStop && (weaponEnabled || !linkDegraded())) {
     weaponEnabled = !weaponEnabled;
     digitalWrite(WEAPON_PIN, weaponEnabled ? HIGH : LOW);
     
     // Status feedback
     Serial.println(weaponEnabled ? "WEAPON ON" : "WEAPON OFF");
     
-    // Safety blink pattern
-    for (int i = 0; i < 3; i++) {
-      digitalWrite(LED_STATUS, LOW);
-      delay(100);
-      digitalWrite(LED_STATUS, HIGH);
-      delay(100);
-    }
+    // Safety blink pattern - run by updateStatusIndicators() so the
+    // loop never stalls long enough to starve the watchdog
+    weaponBlinksLeft = 6;
   }
 }
 // Safety system implementations - Competition grade
 void executeEmergencyShutdown() {
   emergencyStop = true;
+  rearmPending = false;
   
   // Immediate motor shutdown
   leftMotor.emergencyStop();
   rightMotor.emergencyStop();
+  linkLoss.holdLeft = 0;
+  linkLoss.holdRight = 0;
   
   // Disable weapon immediately
   weaponEnabled = false;
   digitalWrite(WEAPON_PIN, LOW);
   
   // Visual indicator - Rapid blink
-  digitalWrite(LED_STATUS, LOW);
+  digitalWrite(LED_STATUS_PIN, LOW);
   
+  blackBoxEvent(BLACKBOX_EVENT_ESTOP);
   Serial.println("EMERGENCY STOP ACTIVATED");
+}
+
+// Emergency state - one non-blocking pass per loop() until re-armed
+// Re-arm sequence: RESET/RST with the e-stop released, then the e-stop must
+// stay released for ESTOP_REARM_HOLD_MS. A re-press at any point starts over.
+void serviceEmergencyStop() {
+  static unsigned long lastBlink = 0;
   
-  // Stay in emergency state until reset
-  while (emergencyStop || hardwareEmergencyStop) {
-    // Blink pattern to indicate emergency state
-    digitalWrite(LED_STATUS, !digitalRead(LED_STATUS));
-    delay(200);
-    
-    // Check for reset command
-    if (bluetooth.available()) {
-      String resetCmd = bluetooth.readString();
-      resetCmd.trim();
-      if (resetCmd == "RESET" || resetCmd == "RST") {
-        emergencyStop = false;
-        hardwareEmergencyStop = false;
-        digitalWrite(LED_STATUS, HIGH);
-        Serial.println("EMERGENCY RESET - SYSTEM ACTIVE");
-        break;
+  // Waiting for a reset is not a hang
+  heartbeat(TASK_COMMS);
+  
+  // Blink pattern to indicate emergency state
+  if (millis() - lastBlink >= 200) {
+    digitalWrite(LED_STATUS_PIN, !digitalRead(LED_STATUS_PIN));
+    lastBlink = millis();
+  }
+  
+  bool pressed = digitalRead(EMERGENCY_STOP_PIN) == LOW;
+  if (pressed) {
+    rearmPending = false;
+  }
+  
+  // Check for reset command
+  String resetCmd;
+  if (readBluetoothCommand(resetCmd)) {
+    resetCmd.trim();
+    int sequence = packetSequence(resetCmd);
+    if (sequence >= 0 && resetCmd.charAt(5) == 'E' && packetChecksumValid(resetCmd)) {
+      // A resent emergency packet is already satisfied - stop the retries
+      sendAck(sequence);
+    } else if (resetCmd == "RESET" || resetCmd == "RST") {
+      if (pressed) {
+        Serial.println("RESET REFUSED - E-STOP PRESSED");
+      } else if (!rearmPending) {
+        rearmStartTime = millis();
+        rearmPending = true;
+        Serial.println("EMERGENCY RESET - REARMING");
       }
     }
   }
+  
+  if (rearmPending && millis() - rearmStartTime >= ESTOP_REARM_HOLD_MS) {
+    // Final pin check and clear in one step, so a trip from the ISR in
+    // between cannot be overwritten
+    noInterrupts();
+    bool released = rearmPending && digitalRead(EMERGENCY_STOP_PIN) == HIGH;
+    if (released) {
+      rearmPending = false;
+      hardwareEmergencyStop = false;
+      emergencyStop = false;
+    }
+    interrupts();
+    if (!released) return;
+    
+    lastCommandTime = millis();
+    digitalWrite(LED_STATUS_PIN, HIGH);
+    Serial.println("EMERGENCY RESET - SYSTEM ACTIVE");
+  }
 }
 
 void executeSafetyTimeout() {
@@ -380,24 +692,144 @@ void executeSafetyTimeout() {
   // Slow blink to indicate timeout state
   static unsigned long lastBlink = 0;
   if (millis() - lastBlink > 1000) {
-    digitalWrite(LED_STATUS, !digitalRead(LED_STATUS));
+    digitalWrite(LED_STATUS_PIN, !digitalRead(LED_STATUS_PIN));
     lastBlink = millis();
   }
   
-  Serial.println("SAFETY TIMEOUT - NO SIGNAL");
+  // Printed every pass, so it would starve a black-box download
+  if (!blackBox.dumping) {
+    Serial.println("SAFETY TIMEOUT - NO SIGNAL");
+  }
 }
 
 // Hardware interrupt service routine - Competition requirement
 void hardwareEmergencyISR() {
-  // Interrupt-driven emergency stop - sub-1µs response time
+  // Cut motors and weapon right here - the loop may be busy for a while
+  killOutputsFromISR();
   hardwareEmergencyStop = true;
+  rearmPending = false;
+}
+
+// Watchdog - per-task heartbeats gate the hardware WDT
+void heartbeat(uint8_t task) {
+  taskHeartbeat[task] = millis();
 }
 
-// Motor system updates - Smooth operation
+uint8_t staleTasks() {
+  unsigned long now = millis();
+  uint8_t stale = 0;
+  for (uint8_t i = 0; i < TASK_COUNT; i++) {
+    if (now - taskHeartbeat[i] > HEARTBEAT_TIMEOUT_MS) {
+      stale |= _BV(i);
+    }
+  }
+  return stale;
+}
+
+void serviceWatchdog() {
+  // After the interrupt has cut the outputs, let the reset happen
+  if (!watchdogTripped && staleTasks() == 0) {
+    wdt_reset();
+  }
+}
+
+void enableWatchdog() {
+  for (uint8_t i = 0; i < TASK_COUNT; i++) {
+    heartbeat(i);
+  }
+  
+  // Interrupt-and-reset mode: first timeout runs ISR(WDT_vect), second resets
+  noInterrupts();
+  wdt_reset();
+  WDTCSR |= _BV(WDCE) | _BV(WDE);
+  WDTCSR = _BV(WDIE) | _BV(WDE) |
+           ((WATCHDOG_PERIOD & 0x08) ? _BV(WDP3) : 0) | (WATCHDOG_PERIOD & 0x07);
+  interrupts();
+}
+
+void reportResetCause() {
+  uint8_t resetFlags = MCUSR;
+  MCUSR = 0;
+  wdt_disable();
+  
+  Serial.print("RESET CAUSE: ");
+  if (watchdogRecord.magic == WATCHDOG_RECORD_MAGIC) {
+    Serial.print("WATCHDOG - stale tasks 0x");
+    Serial.println(watchdogRecord.staleTasks, HEX);
+  } else if (resetFlags & _BV(BORF)) {
+    Serial.println("BROWN-OUT");
+  } else if (resetFlags & _BV(EXTRF)) {
+    Serial.println("EXTERNAL");
+  } else {
+    Serial.println("POWER-ON");
+  }
+  watchdogRecord.magic = 0;
+}
+
+// Direct register writes - safe in any interrupt, no Arduino core calls
+void killOutputsFromISR() {
+  TCCR1A &= ~(_BV(COM1A1) | _BV(COM1B1));   // Pins 9, 10 - motor PWM
+  TCCR2A &= ~_BV(COM2B1);                   // Pin 3 - weapon
+  TCCR0A &= ~(_BV(COM0A1) | _BV(COM0B1));   // Pins 5, 6
+  PORTB &= ~(_BV(PB0) | _BV(PB1) | _BV(PB2));              // Pins 8, 9, 10
+  PORTD &= ~(_BV(PD3) | _BV(PD5) | _BV(PD6) | _BV(PD7));   // Pins 3, 5, 6, 7
+}
+
+ISR(WDT_vect) {
+  // Loop is stuck - outputs first, diagnostics second
+  killOutputsFromISR();
+  watchdogRecord.magic = WATCHDOG_RECORD_MAGIC;
+  watchdogRecord.staleTasks = staleTasks();
+  watchdogTripped = true;
+}
+
+// Motor system updates - link-loss tiers by time since the last command
+// Tier 1 holds the last command (finishing its ramp), tier 2 slews towards
+// stop at LINK_DECAY_RATE, tier 3 is executeSafetyTimeout() at
+// SAFETY_TIMEOUT_MS. Bluetooth micro-dropouts of 50-200ms no longer jerk
+// the robot, and a dead link still stops it on time.
 void updateMotorSystems() {
-  // This function handles acceleration ramping and smooth transitions
-  // Implementation is handled within the WormMotorController class
-  // Additional motor monitoring could be added here
+  // The e-stop ISR may have fired since loop() checked: leave its outputs cut
+  if (emergencyStop || hardwareEmergencyStop) return;
+  
+  unsigned long now = millis();
+  unsigned long elapsed = now - linkLoss.lastUpdate;
+  linkLoss.lastUpdate = now;
+  
+  if (now - lastCommandTime < LINK_HOLD_MS) {
+    #if LINK_HOLD_FOLLOW_RAMP
+    // The motors only ramp when told to: keep telling them
+    if (!linkLoss.decaying && (!leftMotor.isSettled() || !rightMotor.isSettled())) {
+      leftMotor.setSpeed(linkLoss.holdLeft);
+      rightMotor.setSpeed(linkLoss.holdRight);
+    }
+    #endif
+    return;
+  }
+  
+  // Decay from wherever the motors actually are
+  if (!linkLoss.decaying) {
+    linkLoss.decaying = true;
+    linkLoss.decayLeft = leftMotor.getSpeed();
+    linkLoss.decayRight = rightMotor.getSpeed();
+    linkLoss.slewCredit = 0;
+  }
+  
+  linkLoss.slewCredit += (uint32_t)LINK_DECAY_RATE * min(elapsed, 1000UL);
+  int step = linkLoss.slewCredit / 1000;
+  if (step == 0) return;
+  linkLoss.slewCredit -= step * 1000UL;
+  
+  linkLoss.decayLeft = slewTowardsZero(linkLoss.decayLeft, step);
+  linkLoss.decayRight = slewTowardsZero(linkLoss.decayRight, step);
+  leftMotor.setSpeed(linkLoss.decayLeft);
+  rightMotor.setSpeed(linkLoss.decayRight);
+}
+
+int slewTowardsZero(int speed, int step) {
+  if (speed > step) return speed - step;
+  if (speed < -step) return speed + step;
+  return 0;
 }
 
 // Status indicator management
@@ -405,9 +837,13 @@ void updateStatusIndicators() {
   static unsigned long lastUpdate = 0;
   
   if (millis() - lastUpdate > 100) {  // Update every 100ms
-    if (!emergencyStop && !hardwareEmergencyStop) {
+    if (weaponBlinksLeft > 0) {
+      // Weapon toggle acknowledgment
+      digitalWrite(LED_STATUS_PIN, (weaponBlinksLeft & 1) ? HIGH : LOW);
+      weaponBlinksLeft--;
+    } else if (!emergencyStop && !hardwareEmergencyStop) {
       // Normal operation - steady on
-      digitalWrite(LED_STATUS, HIGH);
+      digitalWrite(LED_STATUS_PIN, HIGH);
     }
     lastUpdate = millis();
   }
@@ -431,40 +867,546 @@ void testMotorSystems() {
 
 // Packet-based protocol implementation - Advanced
 void processPacketCommand(String packet) {
-  // Extract packet components: "!05M15020099#"
-  if (packet.length() < 7) return;
-  
-  int length = packet.substring(1, 3).toInt();
-  if (length != packet.length() - 2) return; // Length mismatch
-  
-  char command = packet.charAt(3);
-  String data = packet.substring(4, packet.length() - 3);
-  String checksum = packet.substring(packet.length() - 3, packet.length() - 1);
-  
-  // Verify checksum (simple implementation)
-  int calculatedChecksum = 0;
-  for (int i = 1; i < packet.length() - 3; i++) {
-    calculatedChecksum += packet.charAt(i);
-  }
-  calculatedChecksum = calculatedChecksum % 100;
-  
-  if (calculatedChecksum != checksum.toInt()) {
+  // Extract packet components: "!11M15020071#", sequenced "!1307M15020076#"
+  if (!packetChecksumValid(packet)) {
     Serial.println("PACKET ERROR - Checksum failed");
     return;
   }
   
+  int sequence = packetSequence(packet);
+  int commandIndex = sequence >= 0 ? 5 : 3;
+  char command = packet.charAt(commandIndex);
+  blackBox.command = command;
+  String data = packet.substring(commandIndex + 1, packet.length() - 3);
+  
+  bool critical = isCriticalCommand(command);
+  if (sequence >= 0) {
+    uint8_t verdict = linkAccept(sequence, critical);
+    
+    // Never run a command twice; a repeat means the ACK was lost
+    if (verdict == LINK_DUPLICATE) {
+      if (critical) sendAck(sequence);
+      return;
+    }
+    
+    // A late or stale motion packet is older than what the motors are
+    // doing now; a critical one still runs and is ACKed
+    if (verdict != LINK_NEW && !critical) return;
+  }
+  
   // Process verified packet
   switch (command) {
-    case 'M': // Movement command
+    case 'M': // Movement command, same axes as the plain M format
       if (data.length() == 6) {
-        int left = data.substring(0, 3).toInt() - 127;
-        int right = data.substring(3, 6).toInt() - 127;
-        setBothMotors(left, right);
+        setDifferentialDrive(decodeAxis(data.substring(0, 3).toInt()),
+                             decodeAxis(data.substring(3, 6).toInt()));
       }
       break;
+    case 'D': // Drive mode
+      setDriveMode(data.charAt(0) - '0');
+      break;
     case 'W': // Weapon command
-      weaponEnabled = (data.charAt(0) == '1');
-      digitalWrite(WEAPON_PIN, weaponEnabled ? HIGH : LOW);
+      if (!emergencyStop && !hardwareEmergencyStop) {
+        weaponEnabled = (data.charAt(0) == '1') && !linkDegraded();
+        digitalWrite(WEAPON_PIN, weaponEnabled ? HIGH : LOW);
+      }
       break;
+    case 'E': // Emergency stop
+      executeEmergencyShutdown();
+      break;
+    case 'Q': // Controller-side RSSI, data = -dBm
+      linkStats.signalStrength = -data.toInt();
+      break;
+  }
+  
+  // ACK means delivered; the outcome shows in the '?' status
+  if (critical && sequence >= 0) {
+    sendAck(sequence);
+  }
+}
+
+bool packetChecksumValid(String packet) {
+  // Length counts everything between the delimiters
+  if (packet.length() < 7 || !packet.endsWith("#")) return false;
+  if (packet.substring(1, 3).toInt() != (int)packet.length() - 2) return false;
+  
+  int calculatedChecksum = 0;
+  for (unsigned int i = 1; i < packet.length() - 3; i++) {
+    calculatedChecksum += packet.charAt(i);
+  }
+  return calculatedChecksum % 100 == packet.substring(packet.length() - 3, packet.length() - 1).toInt();
+}
+
+// Sequenced packets carry two digits where the command letter would be
+int packetSequence(String packet) {
+  if (!packet.startsWith("!") || packet.length() < 9) return -1;
+  char high = packet.charAt(3);
+  char low = packet.charAt(4);
+  if (high < '0' || high > '9' || low < '0' || low > '9') return -1;
+  return (high - '0') * 10 + (low - '0');
+}
+
+// Weapon, emergency and mode changes are ACKed and never run twice;
+// motion is fire-and-forget, the next packet supersedes a lost one
+bool isCriticalCommand(char command) {
+  return command == 'W' || command == 'E' || command == 'D';
+}
+
+void sendAck(uint8_t sequence) {
+  // Four bytes: short enough that ACKing never stalls the loop
+  bluetooth.write('K');
+  bluetooth.write('0' + sequence / 10 % 10);
+  bluetooth.write('0' + sequence % 10);
+  bluetooth.write('\n');
+}
+
+// Link quality monitor - sequence numbers wrap at LINK_SEQ_MODULO, up to
+// half the range ahead is newer, a bitmap of the last LINK_SEQ_WINDOW
+// sequences tells late first copies from duplicates, and the first packet
+// after LINK_RESYNC_MS of silence starts a fresh window
+uint8_t linkAccept(uint8_t sequence, bool critical) {
+  sequence %= LINK_SEQ_MODULO;
+  unsigned long now = millis();
+  unsigned long quiet = now - linkStats.lastPacket;
+  linkStats.lastPacket = now;
+  
+  if (!linkStats.started || quiet >= LINK_RESYNC_MS) {
+    linkStats.started = true;
+    linkStats.highest = sequence;
+    linkStats.window = 1;
+    linkStats.received++;
+    linkStats.lastArrival = now;
+    linkStats.lastInterval = 0;
+    return LINK_NEW;
+  }
+  
+  uint8_t ahead = (sequence + LINK_SEQ_MODULO - linkStats.highest) % LINK_SEQ_MODULO;
+  if (ahead > 0 && ahead < LINK_SEQ_MODULO / 2) {
+    // Newer: everything skipped is lost until it turns up late
+    uint8_t gap = ahead - 1;
+    linkStats.lost += gap;
+    linkRecordLoss(gap);
+    if (gap >= PACKET_LOSS_THRESHOLD) linkFlagBurst();
+    
+    linkStats.window = ahead < LINK_SEQ_WINDOW ? (linkStats.window << ahead) | 1 : 1;
+    linkStats.highest = sequence;
+    linkStats.received++;
+    linkRecordArrival(ahead);
+    return LINK_NEW;
+  }
+  
+  // Outside the bitmap we cannot tell, so count it with the duplicates;
+  // the caller still runs a critical command
+  uint8_t behind = (LINK_SEQ_MODULO - ahead) % LINK_SEQ_MODULO;
+  if (behind >= LINK_SEQ_WINDOW) {
+    linkStats.duplicates++;
+    return LINK_STALE;
   }
-}
\ No newline at end of file
+  
+  uint32_t bit = 1UL << behind;
+  if (linkStats.window & bit) {
+    linkStats.duplicates++;
+    
+    // Repeated critical packets mean our ACKs are not getting back
+    if (critical) {
+      if (sequence != linkStats.retrySequence) {
+        linkStats.retrySequence = sequence;
+        linkStats.retries = 0;
+      }
+      if (++linkStats.retries >= BLUETOOTH_RETRY_COUNT) linkFlagBurst();
+    }
+    return LINK_DUPLICATE;
+  }
+  
+  // First copy of a packet already counted as lost
+  linkStats.window |= bit;
+  linkStats.received++;
+  if (linkStats.lost > 0) linkStats.lost--;
+  linkStats.reordered++;
+  return LINK_LATE;
+}
+
+void linkRecordLoss(uint8_t count) {
+  // Moving average over ~16 packets, percent in Q8
+  for (uint8_t i = 0; i < count; i++) {
+    linkStats.lossAverage = linkStats.lossAverage - (linkStats.lossAverage >> 4) + ((100U << 8) >> 4);
+  }
+  linkStats.lossAverage -= linkStats.lossAverage >> 4;
+}
+
+void linkRecordArrival(uint8_t steps) {
+  // RFC 3550 style jitter, J += (|D| - J) / 16, on the per-packet interval
+  unsigned long now = millis();
+  unsigned long interval = (now - linkStats.lastArrival) / steps;
+  if (linkStats.lastInterval > 0) {
+    unsigned long change = interval > linkStats.lastInterval ? interval - linkStats.lastInterval
+                                                        : linkStats.lastInterval - interval;
+    change = min(change, 4095UL);
+    linkStats.jitterQ4 = linkStats.jitterQ4 + change - (linkStats.jitterQ4 >> 4);
+  }
+  linkStats.lastInterval = interval;
+  linkStats.lastArrival = now;
+}
+
+void linkFlagBurst() {
+  linkStats.burstActive = true;
+  linkStats.burstTime = millis();
+}
+
+bool linkDegraded() {
+  if (linkStats.burstActive && millis() - linkStats.burstTime >= LINK_DEGRADED_HOLD_MS) {
+    linkStats.burstActive = false;
+  }
+  return linkStats.burstActive ||
+         (linkStats.lossAverage >> 8) >= LINK_LOSS_LIMIT_PERCENT ||
+         (linkStats.signalStrength != 0 && linkStats.signalStrength < SIGNAL_STRENGTH_THRESHOLD);
+}
+
+uint8_t linkPercent(unsigned long count) {
+  unsigned long expected = linkStats.received + linkStats.lost;
+  return expected == 0 ? 0 : min(count * 100UL / expected, 100UL);
+}
+
+void reportLinkStatus() {
+  bluetooth.print(linkDegraded() ? "LINK_DEGRADED" : "LINK_OK");
+  bluetooth.print(" rx=");
+  bluetooth.print(linkStats.received);
+  bluetooth.print(" loss=");
+  bluetooth.print(linkPercent(linkStats.lost));
+  bluetooth.print("% reord=");
+  bluetooth.print(linkPercent(linkStats.reordered));
+  bluetooth.print("% dup=");
+  bluetooth.print(linkPercent(linkStats.duplicates));
+  bluetooth.print("% jit=");
+  bluetooth.print(linkStats.jitterQ4 >> 4);
+  bluetooth.print("ms");
+  if (linkStats.signalStrength != 0) {
+    bluetooth.print(" rssi=");
+    bluetooth.print(linkStats.signalStrength);
+  }
+  bluetooth.println();
+}
+
+// Black-box recorder - one record per BLACKBOX_SAMPLE_MS into the RAM ring.
+// Records are evicted whole from the oldest end. E-stop, watchdog and match
+// end copy the ring to the next EEPROM slot, at most one byte write per pass;
+// sampling pauses while the ring is being copied or downloaded.
+void blackBoxBegin(uint8_t resetFlags) {
+  // Carry on after the newest committed slot
+  int newest = BLACKBOX_EEPROM_SLOTS - 1;
+  bool found = false;
+  for (uint8_t slot = 0; slot < BLACKBOX_EEPROM_SLOTS; slot++) {
+    uint16_t base = BLACKBOX_EEPROM_START + slot * BLACKBOX_SLOT_BYTES;
+    uint16_t magic = blackBoxEepromRead(base) | (blackBoxEepromRead(base + 1) << 8);
+    if (magic != BLACKBOX_SLOT_MAGIC) continue;
+    uint16_t sequence = blackBoxEepromRead(base + 2) | (blackBoxEepromRead(base + 3) << 8);
+    if (!found || (int16_t)(sequence - blackBox.sequence) > 0) {
+      found = true;
+      newest = slot;
+      blackBox.sequence = sequence;
+    }
+  }
+  blackBox.commitSlot = (newest + 1) % BLACKBOX_EEPROM_SLOTS;
+  
+  // RAM is garbage after a power-on; any other reset leaves the ring intact
+  if (!(resetFlags & _BV(PORF)) && blackBoxRingValid()) {
+    blackBox.pendingEvent = (resetFlags & _BV(WDRF)) ? BLACKBOX_EVENT_WATCHDOG : BLACKBOX_EVENT_REBOOT;
+    Serial.print("BLACK BOX RECOVERED ");
+    Serial.print(blackBoxRing.used);
+    Serial.println(" BYTES");
+  } else {
+    blackBoxRing.magic = BLACKBOX_RING_MAGIC;
+    blackBoxRing.head = 0;
+    blackBoxRing.used = 0;
+    blackBoxSeal();
+  }
+  
+  blackBox.forceKeyframe = true;
+  blackBox.idleRun = -1;
+  blackBox.lastSample = millis() - BLACKBOX_SAMPLE_MS;
+}
+
+void blackBoxEvent(uint8_t event) {
+  // The first event wins until it has been logged
+  if (blackBox.pendingEvent == BLACKBOX_EVENT_NONE) blackBox.pendingEvent = event;
+}
+
+void serviceBlackBox() {
+  blackBoxRecord();
+  if (blackBox.committing) {
+    blackBoxServiceCommit();
+  } else if (blackBox.dumping) {
+    blackBoxServiceDump();
+  }
+  processLogRequest();
+}
+
+uint8_t blackBoxSafetyBits() {
+  uint8_t bits = 0;
+  if (emergencyStop || hardwareEmergencyStop) bits |= BLACKBOX_SAFETY_ESTOP;
+  if (millis() - lastCommandTime > SAFETY_TIMEOUT_MS) {
+    bits |= BLACKBOX_SAFETY_TIMEOUT | (2 << BLACKBOX_SAFETY_TIER_SHIFT);
+  } else if (linkLoss.decaying) {
+    bits |= 1 << BLACKBOX_SAFETY_TIER_SHIFT;
+  }
+  if (weaponEnabled) bits |= BLACKBOX_SAFETY_WEAPON;
+  if (linkDegraded()) bits |= BLACKBOX_SAFETY_LINK;
+  return bits;
+}
+
+void blackBoxRecord() {
+  unsigned long now = millis();
+  if (now - blackBox.lastSample < BLACKBOX_SAMPLE_MS) return;
+  
+  // A pause or a stalled loop breaks the timeline: restart with a keyframe
+  bool paused = blackBox.committing || blackBox.dumping;
+  if (paused || now - blackBox.lastSample >= 2 * BLACKBOX_SAMPLE_MS) {
+    blackBox.forceKeyframe = true;
+    blackBox.lastSample = now;
+    if (paused) return;
+  } else {
+    blackBox.lastSample += BLACKBOX_SAMPLE_MS;
+  }
+  
+  int left = leftMotor.getSpeed();
+  int right = rightMotor.getSpeed();
+  uint8_t safety = blackBoxSafetyBits();
+  int leftDelta = left - blackBox.lastLeft;
+  int rightDelta = right - blackBox.lastRight;
+  uint8_t event = blackBox.pendingEvent;
+  blackBox.pendingEvent = BLACKBOX_EVENT_NONE;
+  
+  if (blackBox.forceKeyframe || leftDelta < -128 || leftDelta > 127 ||
+      rightDelta < -128 || rightDelta > 127 ||
+      ++blackBox.sinceKeyframe >= BLACKBOX_KEYFRAME_SAMPLES) {
+    unsigned long time = blackBox.lastSample;
+    uint8_t record[BLACKBOX_KEYFRAME_BYTES] = {
+      BLACKBOX_KEYFRAME,
+      (uint8_t)time, (uint8_t)(time >> 8), (uint8_t)(time >> 16), (uint8_t)(time >> 24),
+      (uint8_t)left, (uint8_t)(left >> 8), (uint8_t)right, (uint8_t)(right >> 8),
+      safety, 0, (uint8_t)blackBox.command, event
+    };
+    blackBoxAppend(record, BLACKBOX_KEYFRAME_BYTES);
+    blackBox.forceKeyframe = false;
+    blackBox.sinceKeyframe = 0;
+    blackBox.idleRun = -1;
+  } else {
+    uint8_t record[6];
+    uint8_t length = 1;
+    record[0] = 0;
+    if (leftDelta != 0) { record[0] |= BLACKBOX_DELTA_LEFT; record[length++] = leftDelta; }
+    if (rightDelta != 0) { record[0] |= BLACKBOX_DELTA_RIGHT; record[length++] = rightDelta; }
+    if (safety != blackBox.lastSafety) { record[0] |= BLACKBOX_DELTA_SAFETY; record[length++] = safety; }
+    if (blackBox.command != 0) { record[0] |= BLACKBOX_DELTA_COMMAND; record[length++] = blackBox.command; }
+    if (event != 0) { record[0] |= BLACKBOX_DELTA_EVENT; record[length++] = event; }
+    
+    if (record[0] != 0) {
+      blackBoxAppend(record, length);
+      blackBox.idleRun = -1;
+    } else if (blackBox.idleRun >= 0 &&
+               blackBoxRing.data[blackBox.idleRun] != (BLACKBOX_IDLE_RUN | BLACKBOX_IDLE_MAX)) {
+      blackBoxRing.data[blackBox.idleRun]++;   // One more unchanged sample
+    } else {
+      uint8_t run = BLACKBOX_IDLE_RUN | 1;
+      blackBoxAppend(&run, 1);
+      blackBox.idleRun = (blackBoxRing.head + BLACKBOX_RING_BYTES - 1) % BLACKBOX_RING_BYTES;
+    }
+  }
+  
+  blackBox.lastLeft = left;
+  blackBox.lastRight = right;
+  blackBox.lastSafety = safety;
+  blackBox.command = 0;
+  
+  if (event == BLACKBOX_EVENT_ESTOP || event == BLACKBOX_EVENT_WATCHDOG ||
+      event == BLACKBOX_EVENT_MATCH_END) {
+    blackBox.committing = true;
+    blackBox.commitReason = event;
+    blackBox.commitStep = 0;
+    blackBox.commitLength = blackBoxRing.used;
+    blackBox.commitTail = blackBoxTail();
+    blackBox.commitSum = 0;
+  }
+}
+
+void blackBoxAppend(const uint8_t *bytes, uint8_t length) {
+  // Evict whole records so the ring always starts on a record
+  while (BLACKBOX_RING_BYTES - blackBoxRing.used < length) {
+    uint16_t tail = blackBoxTail();
+    if ((int)tail == blackBox.idleRun) blackBox.idleRun = -1;
+    blackBoxRing.used -= min((uint16_t)blackBoxRecordLength(blackBoxRing.data[tail]), blackBoxRing.used);
+  }
+  
+  for (uint8_t i = 0; i < length; i++) {
+    blackBoxRing.data[blackBoxRing.head] = bytes[i];
+    blackBoxRing.head = (blackBoxRing.head + 1) % BLACKBOX_RING_BYTES;
+  }
+  blackBoxRing.used += length;
+  blackBoxSeal();
+}
+
+uint16_t blackBoxTail() {
+  return (blackBoxRing.head + BLACKBOX_RING_BYTES - blackBoxRing.used) % BLACKBOX_RING_BYTES;
+}
+
+void blackBoxSeal() {
+  blackBoxRing.check = blackBoxRing.magic ^ blackBoxRing.head ^ blackBoxRing.used;
+}
+
+uint8_t blackBoxRecordLength(uint8_t type) {
+  if (type & BLACKBOX_IDLE_RUN) return 1;
+  if (type == BLACKBOX_KEYFRAME) return BLACKBOX_KEYFRAME_BYTES;
+  uint8_t length = 1;
+  for (uint8_t bit = BLACKBOX_DELTA_LEFT; bit <= BLACKBOX_DELTA_EVENT; bit <<= 1) {
+    if (type & bit) length++;
+  }
+  return length;
+}
+
+bool blackBoxRingValid() {
+  if (blackBoxRing.magic != BLACKBOX_RING_MAGIC || blackBoxRing.head >= BLACKBOX_RING_BYTES ||
+      blackBoxRing.used > BLACKBOX_RING_BYTES ||
+      blackBoxRing.check != (uint16_t)(blackBoxRing.magic ^ blackBoxRing.head ^ blackBoxRing.used)) {
+    return false;
+  }
+  
+  // Records must tile the used bytes exactly
+  uint16_t tail = blackBoxTail();
+  uint16_t walked = 0;
+  while (walked < blackBoxRing.used) {
+    walked += blackBoxRecordLength(blackBoxRing.data[(tail + walked) % BLACKBOX_RING_BYTES]);
+  }
+  return walked == blackBoxRing.used;
+}
+
+uint8_t blackBoxEepromRead(uint16_t address) {
+  return eeprom_read_byte((const uint8_t *)(uintptr_t)address);
+}
+
+// EEPROM commit: clear the old magic, write the ring, then the header with
+// the magic last - a commit cut short leaves an invalid slot, and the slot
+// before it intact
+bool blackBoxCommitByte(uint16_t step, uint16_t &address, uint8_t &value) {
+  uint16_t base = BLACKBOX_EEPROM_START + blackBox.commitSlot * BLACKBOX_SLOT_BYTES;
+  
+  if (step == 0) {
+    address = base;
+    value = blackBoxEepromRead(base) == (BLACKBOX_SLOT_MAGIC & 0xFF) ? 0 : blackBoxEepromRead(base);
+    return true;
+  }
+  if (step <= blackBox.commitLength) {
+    address = base + BLACKBOX_SLOT_HEADER_BYTES + step - 1;
+    value = blackBoxRing.data[(blackBox.commitTail + step - 1) % BLACKBOX_RING_BYTES];
+    return true;
+  }
+  
+  static const uint8_t order[BLACKBOX_SLOT_HEADER_BYTES] = { 2, 3, 4, 5, 6, 7, 1, 0 };
+  uint16_t index = step - blackBox.commitLength - 1;
+  if (index >= BLACKBOX_SLOT_HEADER_BYTES) return false;
+  
+  uint16_t sequence = blackBox.sequence + 1;
+  uint8_t header[BLACKBOX_SLOT_HEADER_BYTES] = {
+    (uint8_t)BLACKBOX_SLOT_MAGIC, (uint8_t)(BLACKBOX_SLOT_MAGIC >> 8),
+    (uint8_t)sequence, (uint8_t)(sequence >> 8), blackBox.commitReason,
+    (uint8_t)blackBox.commitLength, (uint8_t)(blackBox.commitLength >> 8), blackBox.commitSum
+  };
+  address = base + order[index];
+  value = header[order[index]];
+  return true;
+}
+
+void blackBoxServiceCommit() {
+  // A byte write runs 3.4ms in the background - never wait for it
+  for (uint8_t n = 0; n < BLACKBOX_COMMIT_BYTES_PER_LOOP; n++) {
+    if (!eeprom_is_ready()) return;
+    
+    uint16_t address;
+    uint8_t value;
+    if (!blackBoxCommitByte(blackBox.commitStep, address, value)) {
+      blackBox.committing = false;
+      blackBox.sequence++;
+      blackBox.commitSlot = (blackBox.commitSlot + 1) % BLACKBOX_EEPROM_SLOTS;
+      Serial.println("BLACK BOX SAVED");
+      return;
+    }
+    
+    if (blackBox.commitStep > 0 && blackBox.commitStep <= blackBox.commitLength) {
+      blackBox.commitSum += value;
+    }
+    blackBox.commitStep++;
+    
+    // Unchanged bytes cost no wear
+    if (blackBoxEepromRead(address) != value) {
+      eeprom_write_byte((uint8_t *)(uintptr_t)address, value);
+      return;
+    }
+  }
+}
+
+// Download: one line per pass, only when it fits in the TX buffer
+void blackBoxServiceDump() {
+  const uint16_t eepromBytes = BLACKBOX_EEPROM_SLOTS * BLACKBOX_SLOT_BYTES;
+  String line = "BB ";
+  uint8_t nextPhase = blackBox.dumpPhase + 1;
+  uint16_t nextOffset = 0;
+  
+  if (blackBox.dumpPhase == 0) {
+    line += "EEPROM " + String(BLACKBOX_EEPROM_START) + " " + String(BLACKBOX_EEPROM_SLOTS) +
+            " " + String(BLACKBOX_SLOT_BYTES) + " " + String(BLACKBOX_SAMPLE_MS);
+  } else if (blackBox.dumpPhase == 2) {
+    line += "RAM " + String(blackBoxRing.used);
+  } else if (blackBox.dumpPhase == 1 || blackBox.dumpPhase == 3) {
+    bool eeprom = blackBox.dumpPhase == 1;
+    uint16_t total = eeprom ? eepromBytes : blackBoxRing.used;
+    if (total == 0) {
+      blackBox.dumpPhase = nextPhase;
+      return;
+    }
+    uint16_t count = min((uint16_t)(total - blackBox.dumpOffset), (uint16_t)BLACKBOX_DUMP_LINE_BYTES);
+    const char *hex = "0123456789ABCDEF";
+    for (int shift = 12; shift >= 0; shift -= 4) line += hex[(blackBox.dumpOffset >> shift) & 0x0F];
+    line += ' ';
+    for (uint16_t i = 0; i < count; i++) {
+      uint16_t offset = blackBox.dumpOffset + i;
+      uint8_t value = eeprom ? blackBoxEepromRead(BLACKBOX_EEPROM_START + offset)
+                             : blackBoxRing.data[(blackBoxTail() + offset) % BLACKBOX_RING_BYTES];
+      line += hex[value >> 4];
+      line += hex[value & 0x0F];
+    }
+    nextOffset = blackBox.dumpOffset + count;
+    if (nextOffset < total) nextPhase = blackBox.dumpPhase;
+  } else {
+    line += "END";
+  }
+  
+  if (Serial.availableForWrite() < (int)line.length() + 2) return;
+  Serial.println(line);
+  blackBox.dumpOffset = nextPhase == blackBox.dumpPhase ? nextOffset : 0;
+  blackBox.dumpPhase = nextPhase;
+  if (blackBox.dumpPhase > 4) blackBox.dumping = false;
+}
+
+// "LOG" on the USB port starts a download - read without blocking
+void processLogRequest() {
+  static char request[5];
+  static uint8_t length = 0;
+  
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c == '\n' || c == '\r') {
+      request[length] = '\0';
+      if (strcmp(request, "LOG") == 0) {
+        if (blackBox.committing || blackBox.dumping) {
+          Serial.println("BB BUSY");
+        } else {
+          blackBox.dumping = true;
+          blackBox.dumpPhase = 0;
+          blackBox.dumpOffset = 0;
+        }
+      }
+      length = 0;
+    } else if (length < sizeof(request) - 1) {
+      request[length++] = c;
+    }
+  }
+}
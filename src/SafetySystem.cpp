@@ -0,0 +1,268 @@
+#include "../include/SafetySystem.h"
+
+/*
+ * SafetySystem Implementation
+ * Multi-layer safety monitoring for competition use
+ */
+
+SafetySystem* SafetySystem::_instance = nullptr;
+void (*SafetySystem::_emergencyCallback)() = nullptr;
+void (*SafetySystem::_rearmCallback)() = nullptr;
+
+SafetySystem::SafetySystem()
+    : _lastCommandTime(0), _radioTimeout(RADIO_TIMEOUT), _watchdogTimeout(WATCHDOG_TIMEOUT),
+      _linkDegraded(false),
+      _batteryVoltage(0.0), _lowVoltageWarning(false), _criticalVoltage(false),
+      _emergencyStopActive(false), _hardwareEmergencyStop(false),
+      _estopState(ESTOP_ARMED), _rearmStartTime(0),
+      _weaponStartTime(0), _weaponSpinupComplete(false), _weaponRunning(false) {
+}
+
+void SafetySystem::begin() {
+    _instance = this;
+
+    _initializeInterrupts();
+
+    // Start with a fresh timeout window and a real battery reading
+    _lastCommandTime = millis();
+    _batteryVoltage = _readBatteryVoltage();
+    checkBatteryVoltage();
+
+    // Failsafe default: weapon off
+    stopWeapon();
+}
+
+void SafetySystem::attachEmergencyStop(void (*callback)()) {
+    _emergencyCallback = callback;
+}
+
+void SafetySystem::attachRearm(void (*callback)()) {
+    _rearmCallback = callback;
+}
+
+// Safety Monitoring
+void SafetySystem::update() {
+    checkEmergencyStop();
+    _updateRearm();
+    checkTimeouts();
+
+    // Battery sampling is slow (ADC), so rate-limit it
+    static unsigned long lastBatteryCheck = 0;
+    if (millis() - lastBatteryCheck >= SENSOR_UPDATE_RATE) {
+        updateBatteryVoltage(_readBatteryVoltage());
+        lastBatteryCheck = millis();
+    }
+
+    // Weapon maximum run time
+    if (_weaponRunning && millis() - _weaponStartTime > WEAPON_MAX_RUN_TIME) {
+        stopWeapon();
+    }
+
+    _updateStatusLED();
+}
+
+bool SafetySystem::isSafeToOperate() {
+    return !isEmergencyActive() && !isCommunicationTimeout() && !isCriticalVoltage();
+}
+
+void SafetySystem::checkTimeouts() {
+    // Radio loss or a lossy link forces the weapon off; drive stop is
+    // handled by the caller
+    if ((isCommunicationTimeout() || _linkDegraded) && _weaponRunning) {
+        stopWeapon();
+    }
+}
+
+void SafetySystem::checkBatteryVoltage() {
+    float millivolts = _batteryVoltage * 1000.0;
+    _criticalVoltage = millivolts < LOW_VOLTAGE_CUTOFF;
+    _lowVoltageWarning = millivolts < LOW_VOLTAGE_WARNING;
+}
+
+void SafetySystem::checkEmergencyStop() {
+    // Level check backs up the edge-triggered interrupt
+    if (digitalRead(EMERGENCY_STOP_PIN) == LOW && _estopState != ESTOP_TRIPPED) {
+        _emergencyStopISR();
+    }
+}
+
+// Timeout Management
+void SafetySystem::resetCommunicationTimeout() {
+    _lastCommandTime = millis();
+}
+
+bool SafetySystem::isCommunicationTimeout() {
+    return millis() - _lastCommandTime > _radioTimeout;
+}
+
+void SafetySystem::setRadioTimeout(unsigned long timeout) {
+    _radioTimeout = timeout;
+}
+
+void SafetySystem::setLinkDegraded(bool degraded) {
+    _linkDegraded = degraded;
+}
+
+bool SafetySystem::isLinkDegraded() {
+    return _linkDegraded;
+}
+
+// Battery Management
+void SafetySystem::updateBatteryVoltage(float voltage) {
+    _batteryVoltage = voltage;
+    checkBatteryVoltage();
+}
+
+float SafetySystem::getBatteryVoltage() {
+    return _batteryVoltage;
+}
+
+bool SafetySystem::isLowVoltage() {
+    return _lowVoltageWarning;
+}
+
+bool SafetySystem::isCriticalVoltage() {
+    return _criticalVoltage;
+}
+
+// Emergency Procedures
+void SafetySystem::triggerEmergencyStop() {
+    _cutOutputs();
+    _emergencyStopActive = true;
+    _estopState = ESTOP_TRIPPED;
+    stopWeapon();
+}
+
+bool SafetySystem::clearEmergencyStop() {
+    // Hardware stop stays latched while the button is still pressed
+    if (digitalRead(EMERGENCY_STOP_PIN) == LOW) return false;
+    if (_estopState != ESTOP_TRIPPED) return _estopState == ESTOP_REARMING;
+
+    // Outputs stay dead until the release has held for ESTOP_REARM_HOLD_MS
+    _rearmStartTime = millis();
+    _estopState = ESTOP_REARMING;
+    return true;
+}
+
+bool SafetySystem::isEmergencyActive() {
+    return _emergencyStopActive || _hardwareEmergencyStop;
+}
+
+bool SafetySystem::isRearming() {
+    return _estopState == ESTOP_REARMING;
+}
+
+// Status and Diagnostics
+void SafetySystem::printStatus() {
+    Serial.print(F("Safety: "));
+    Serial.println(getStatusString());
+}
+
+String SafetySystem::getStatusString() {
+    String status = isSafeToOperate() ? "OK" : "UNSAFE";
+
+    if (isEmergencyActive()) status += _hardwareEmergencyStop ? " ESTOP_HW" : " ESTOP";
+    if (isCommunicationTimeout()) status += " TIMEOUT";
+    if (_linkDegraded) status += " LINK";
+    if (_criticalVoltage) {
+        status += " CRITICAL_V";
+    } else if (_lowVoltageWarning) {
+        status += " LOW_V";
+    }
+    if (_weaponRunning) status += " WEAPON";
+
+    status += " V=";
+    status += String(_batteryVoltage, 2);
+    return status;
+}
+
+// Weapon Safety
+bool SafetySystem::isWeaponSafe() {
+    return isSafeToOperate() && !isLowVoltage() && !_linkDegraded;
+}
+
+void SafetySystem::startWeaponSpinup() {
+    if (!isWeaponSafe() || _weaponRunning) return;
+
+    _weaponRunning = true;
+    _weaponSpinupComplete = false;
+    _weaponStartTime = millis();
+}
+
+void SafetySystem::stopWeapon() {
+    _weaponRunning = false;
+    _weaponSpinupComplete = false;
+}
+
+bool SafetySystem::isWeaponSpunUp() {
+    if (_weaponRunning && !_weaponSpinupComplete &&
+        millis() - _weaponStartTime >= WEAPON_SPINUP_TIME) {
+        _weaponSpinupComplete = true;
+    }
+    return _weaponSpinupComplete;
+}
+
+// Private Methods
+void SafetySystem::_initializeInterrupts() {
+    pinMode(EMERGENCY_STOP_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(EMERGENCY_STOP_PIN), _emergencyStopISR, FALLING);
+}
+
+float SafetySystem::_readBatteryVoltage() {
+    int raw = analogRead(VOLTAGE_SENSE_PIN);
+    return raw * (5.0 / 1023.0) * VOLTAGE_DIVIDER_RATIO * VOLTAGE_CALIBRATION;
+}
+
+void SafetySystem::_updateStatusLED() {
+    // Solid LED while an emergency stop is latched
+    if (isEmergencyActive()) {
+        digitalWrite(STATUS_LED_PIN, HIGH);
+    }
+}
+
+void SafetySystem::_updateRearm() {
+    if (_estopState != ESTOP_REARMING) return;
+
+    // Any bounce or re-press during the hold aborts the re-arm
+    if (digitalRead(EMERGENCY_STOP_PIN) == LOW) {
+        _estopState = ESTOP_TRIPPED;
+        return;
+    }
+    if (millis() - _rearmStartTime < ESTOP_REARM_HOLD_MS) return;
+
+    // Final pin check and clear in one step, so a trip from the ISR in
+    // between cannot be overwritten
+    noInterrupts();
+    bool released = _estopState == ESTOP_REARMING && digitalRead(EMERGENCY_STOP_PIN) == HIGH;
+    if (released) {
+        _hardwareEmergencyStop = false;
+        _emergencyStopActive = false;
+        _estopState = ESTOP_ARMED;
+    }
+    interrupts();
+    if (!released) return;
+
+    _lastCommandTime = millis();
+
+    if (_rearmCallback) {
+        _rearmCallback();
+    }
+}
+
+void SafetySystem::_emergencyStopISR() {
+    // Outputs first: everything here must fit in EMERGENCY_RESPONSE_US
+    _cutOutputs();
+
+    if (_instance) {
+        _instance->_hardwareEmergencyStop = true;
+        _instance->_emergencyStopActive = true;
+        _instance->_estopState = ESTOP_TRIPPED;
+    }
+}
+
+void SafetySystem::_cutOutputs() {
+    fastPinLow(WEAPON_PWM);
+    if (_emergencyCallback) {
+        _emergencyCallback();
+    }
+}
@@ -0,0 +1,162 @@
+#include "../include/TaskWatchdog.h"
+#include <avr/wdt.h>
+#include <avr/interrupt.h>
+
+/*
+ * TaskWatchdog Implementation
+ * AVR WDT in interrupt-and-reset mode, fed only by healthy heartbeats
+ */
+
+#define WATCHDOG_RECORD_MAGIC 0x5744  // "WD"
+
+// Survives the watchdog reset (not zeroed by the C runtime)
+struct WatchdogRecord {
+    uint16_t magic;
+    uint8_t staleTasks;
+};
+static WatchdogRecord _record __attribute__((section(".noinit")));
+
+TaskWatchdog* TaskWatchdog::_instance = nullptr;
+void (*TaskWatchdog::_preResetHook)() = nullptr;
+
+// The tripped flag lives outside the class so the ISR can set it cheaply
+static volatile bool _tripped = false;
+
+ISR(WDT_vect) {
+    TaskWatchdog::handleInterrupt();
+}
+
+TaskWatchdog::TaskWatchdog()
+    : _taskCount(0), _resetFlags(0), _lastStaleTasks(0), _enabled(false) {
+}
+
+void TaskWatchdog::begin() {
+    _instance = this;
+
+    // Optiboot clears MCUSR on Uno, so the .noinit record written by the
+    // WDT interrupt is the reliable source for watchdog resets
+    _resetFlags = MCUSR;
+    MCUSR = 0;
+    wdt_disable();
+
+    _lastStaleTasks = 0;
+    if (_record.magic == WATCHDOG_RECORD_MAGIC) {
+        _resetFlags |= _BV(WDRF);
+        _lastStaleTasks = _record.staleTasks;
+    }
+    _record.magic = 0;
+    _tripped = false;
+}
+
+void TaskWatchdog::enable() {
+    #if ENABLE_SOFTWARE_WATCHDOG
+    // Outputs are cut after half the timeout, the chip resets at the full timeout
+    uint8_t prescaler = _prescaler(WATCHDOG_TIMEOUT / 2);
+
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        _lastCheckIn[i] = now;
+    }
+
+    noInterrupts();
+    wdt_reset();
+    WDTCSR |= _BV(WDCE) | _BV(WDE);
+    WDTCSR = _BV(WDIE) | _BV(WDE) | ((prescaler & 0x08) ? _BV(WDP3) : 0) | (prescaler & 0x07);
+    interrupts();
+
+    _enabled = true;
+    #endif
+}
+
+void TaskWatchdog::disable() {
+    wdt_disable();
+    _enabled = false;
+}
+
+void TaskWatchdog::attachPreResetHook(void (*hook)()) {
+    _preResetHook = hook;
+}
+
+// Heartbeat Registry
+uint8_t TaskWatchdog::registerTask(unsigned long maxIntervalMs) {
+    if (_taskCount >= WATCHDOG_MAX_TASKS) return WATCHDOG_INVALID_TASK;
+
+    _maxInterval[_taskCount] = maxIntervalMs;
+    _lastCheckIn[_taskCount] = millis();
+    return _taskCount++;
+}
+
+void TaskWatchdog::checkIn(uint8_t taskId) {
+    if (taskId < _taskCount) {
+        _lastCheckIn[taskId] = millis();
+    }
+}
+
+void TaskWatchdog::update() {
+    // Once the pre-reset hook has run the outputs are dead; let the reset happen
+    if (!_enabled || _tripped) return;
+
+    if (isHealthy()) {
+        wdt_reset();
+    }
+}
+
+bool TaskWatchdog::isHealthy() {
+    return getStaleTasks() == 0;
+}
+
+uint8_t TaskWatchdog::getStaleTasks() {
+    unsigned long now = millis();
+    uint8_t stale = 0;
+
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        if (now - _lastCheckIn[i] > _maxInterval[i]) {
+            stale |= _BV(i);
+        }
+    }
+    return stale;
+}
+
+// Reset Diagnostics
+bool TaskWatchdog::wasWatchdogReset() {
+    return _resetFlags & _BV(WDRF);
+}
+
+uint8_t TaskWatchdog::getResetFlags() {
+    return _resetFlags;
+}
+
+uint8_t TaskWatchdog::getLastStaleTasks() {
+    return _lastStaleTasks;
+}
+
+String TaskWatchdog::getResetString() {
+    if (wasWatchdogReset()) {
+        return "WATCHDOG (tasks 0x" + String(_lastStaleTasks, HEX) + ")";
+    }
+    if (_resetFlags & _BV(BORF)) return "BROWN-OUT";
+    if (_resetFlags & _BV(EXTRF)) return "EXTERNAL";
+    if (_resetFlags & _BV(PORF)) return "POWER-ON";
+    return "UNKNOWN";
+}
+
+void TaskWatchdog::handleInterrupt() {
+    // Outputs first - everything else can wait
+    if (_preResetHook) {
+        _preResetHook();
+    }
+
+    _record.magic = WATCHDOG_RECORD_MAGIC;
+    _record.staleTasks = _instance ? _instance->getStaleTasks() : 0;
+    _tripped = true;
+}
+
+// Private Methods
+uint8_t TaskWatchdog::_prescaler(unsigned long periodMs) {
+    // Largest nominal WDT period (15ms << n) that fits, WDTO_15MS .. WDTO_8S
+    uint8_t prescaler = 0;
+    while (prescaler < 9 && (15UL << (prescaler + 1)) <= periodMs) {
+        prescaler++;
+    }
+    return prescaler;
+}
@@ -74,15 +74,26 @@ void WormMotorController::stop() {
 }
 
 void WormMotorController::emergencyStop() {
-    // Interrupt-safe emergency stop
+    // Interrupt-safe emergency stop - same register path as the ISRs
+    killFromISR();
+}
+
+void WormMotorController::killFromISR() {
+    // Direct port writes only: safe from watchdog/e-stop interrupts and
+    // finished in a few microseconds
+    fastPinLow(_pwmPin);
+    fastPinLow(_dir1Pin);
+    fastPinLow(_dir2Pin);
+    
     _emergencyStopActive = true;
     _currentSpeed = 0;
     _targetSpeed = 0;
-    
-    // Direct register manipulation for fastest response
-    digitalWrite(_dir1Pin, LOW);
-    digitalWrite(_dir2Pin, LOW);
-    analogWrite(_pwmPin, 0);
+}
+
+void WormMotorController::clearEmergencyStop() {
+    // Outputs stay off until the next setSpeed()
+    stop();
+    _emergencyStopActive = false;
 }
 
 void WormMotorController::brake() {
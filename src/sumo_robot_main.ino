@@ -15,6 +15,11 @@
 #include "include/WormMotorController.h"
 #include "include/BluetoothComm.h"
 #include "include/SafetySystem.h"
+#include "include/TaskWatchdog.h"
+#include "include/DriveMixer.h"
+#include "include/LinkMonitor.h"
+#include "include/LinkLossPolicy.h"
+#include "include/BlackBox.h"
 
 // ============================================================================
 // GLOBAL OBJECTS
@@ -26,12 +31,28 @@ WormMotorController leftMotor(MOTOR_LEFT_PWM, MOTOR_LEFT_DIR1, MOTOR_LEFT_DIR2,
 WormMotorController rightMotor(MOTOR_RIGHT_PWM, MOTOR_RIGHT_DIR1, MOTOR_RIGHT_DIR2, 
                               MOTOR_DEADBAND_RIGHT, RIGHT_MOTOR_TRIM);
 
+// Drive Mixer (M command axes -> motor speeds)
+DriveMixer driveMixer;
+
+// Link-Loss Policy (hold, decay, stop on Bluetooth dropouts)
+LinkLossPolicy linkLoss;
+
 // Communication System
 BluetoothComm bluetooth(BT_SOFT_RX, BT_SOFT_TX);
+LinkMonitor linkMonitor;
 
 // Safety System
 SafetySystem safety;
 
+// Match Recorder (download over USB with tools/blackbox_dump)
+BlackBox blackBox;
+
+// Watchdog and task heartbeats
+TaskWatchdog watchdog;
+uint8_t loopTask = WATCHDOG_INVALID_TASK;
+uint8_t safetyTask = WATCHDOG_INVALID_TASK;
+uint8_t commsTask = WATCHDOG_INVALID_TASK;
+
 // ============================================================================
 // GLOBAL VARIABLES
 // ============================================================================
@@ -57,6 +78,21 @@ void setup() {
     Serial.println(F("Expert Combat Robotics System"));
     Serial.println(F("================================="));
     
+    // Capture the reset cause before anything else can hang
+    watchdog.begin();
+    Serial.print(F("Reset cause: "));
+    Serial.println(watchdog.getResetString());
+    
+    #if ENABLE_BLACKBOX
+    // A ring left in RAM by a watchdog reset is committed on the first sample
+    blackBox.begin(watchdog.getResetFlags());
+    if (blackBox.getRecovered() > 0) {
+        Serial.print(F("Black box recovered "));
+        Serial.print(blackBox.getRecovered());
+        Serial.println(F(" bytes"));
+    }
+    #endif
+    
     // Initialize status LED
     pinMode(STATUS_LED_PIN, OUTPUT);
     digitalWrite(STATUS_LED_PIN, HIGH);  // LED on during initialization
@@ -67,12 +103,14 @@ void setup() {
     Serial.print(F("Safety System... "));
     safety.begin();
     safety.attachEmergencyStop(emergencyStopHandler);
+    safety.attachRearm(rearmHandler);
     Serial.println(F("OK"));
     
     // Initialize motor controllers
     Serial.print(F("Motor Controllers... "));
     leftMotor.begin();
     rightMotor.begin();
+    linkLoss.begin();
     Serial.println(F("OK"));
     
     // Initialize Bluetooth communication
@@ -90,6 +128,18 @@ void setup() {
     Serial.println(F("Running motor test sequence..."));
     runMotorTest();
     #endif    
+    
+    // Arm the watchdog last so slow setup steps cannot trip it
+    #if ENABLE_SOFTWARE_WATCHDOG
+    Serial.print(F("Watchdog... "));
+    loopTask = watchdog.registerTask();
+    safetyTask = watchdog.registerTask();
+    commsTask = watchdog.registerTask();
+    watchdog.attachPreResetHook(watchdogPreResetHook);
+    watchdog.enable();
+    Serial.println(F("OK"));
+    #endif
+    
     // Final initialization
     digitalWrite(STATUS_LED_PIN, LOW);   // LED off when ready
     robotInitialized = true;
@@ -101,8 +151,13 @@ void setup() {
     Serial.println(F("Command Format:"));
     Serial.println(F("  F/B/L/R/S - Basic movement"));
     Serial.println(F("  F180 - Forward at speed 180"));
-    Serial.println(F("  M150200 - Left=150, Right=200"));
-    Serial.println(F("  !05M15020099# - Packet protocol"));
+    Serial.println(F("  M254127 - Mixed drive, 127 = stop (D0 tank/D1 arcade/D2 curvature)"));
+    Serial.println(F("  !11M15020071# - Packet protocol"));
+    Serial.println(F("  !1307M15020076# - Sequenced packet, W/E/D ACKed as K07"));
+    Serial.println(F("  RESET - Re-arm after emergency stop"));
+    #if ENABLE_BLACKBOX
+    Serial.println(F("  END - Match over, save the black box (LOG on USB downloads it)"));
+    #endif
     Serial.println(F("================================="));
     
     // Reset timing
@@ -116,20 +171,48 @@ void setup() {
 void loop() {
     loopStartTime = micros();
     
+    // Feed the hardware watchdog only if every task checked in on time
+    watchdog.update();
+    watchdog.checkIn(loopTask);
+    
     // Safety system update (highest priority)
     safety.update();
+    watchdog.checkIn(safetyTask);
+    
+    // Black box keeps recording through an e-stop, so it runs before the
+    // safety early-outs
+    #if ENABLE_BLACKBOX
+    serviceBlackBox();
+    #endif
     
     // Check if robot is safe to operate
     if (!safety.isSafeToOperate()) {
         stopAllMotors();
         handleSafetyViolation();
-        return;
+        
+        // Emergency stop only listens for the re-arm request
+        if (safety.isEmergencyActive()) {
+            processRearmCommand();
+            watchdog.checkIn(commsTask);
+            return;
+        }
+        
+        if (safety.isCriticalVoltage()) {
+            watchdog.checkIn(commsTask);  // Deliberately idle, not hung
+            return;
+        }
+        
+        // A link timeout is cleared by the next accepted command, so keep listening
     }
     
     // Process Bluetooth commands
     processBluetoothCommands();
+    watchdog.checkIn(commsTask);
     
-    // Update motor control (smooth acceleration)
+    // A lossy link locks out the weapon until it recovers
+    safety.setLinkDegraded(linkMonitor.isDegraded());
+    
+    // Update motor control (link-loss tiers and ramping)
     updateMotorControl();
     
     // Performance monitoring
@@ -137,8 +220,7 @@ void loop() {
     updatePerformanceMetrics();
     #endif
     
-    // Main loop delay for consistent timing
-    delay(LOOP_DELAY_MS);
+    // No delay(): every periodic task above paces itself off millis()
 }
 // ============================================================================
 // BLUETOOTH COMMAND PROCESSING
@@ -152,16 +234,17 @@ void processBluetoothCommands() {
     
     if (command.length() == 0) return;
     
-    // Reset communication timeout
-    safety.resetCommunicationTimeout();
-    lastCommandTime = millis();
+    #if ENABLE_BLACKBOX
+    blackBox.noteCommand(command.charAt(0));
+    #endif
     
     // Process command based on enabled protocols
     bool commandProcessed = false;
     
     #if SUPPORT_PACKET_PROTOCOL
     if (command.startsWith("!") && command.endsWith("#")) {
-        commandProcessed = processPacketCommand(command);
+        processPacketCommand(command);  // Reports its own errors
+        return;
     }
     #endif
     
@@ -169,11 +252,15 @@ void processBluetoothCommands() {
     if (!commandProcessed && command.startsWith("M")) {
         commandProcessed = processDifferentialCommand(command);
     }
+    if (!commandProcessed && command.startsWith("D") && command.length() == 2) {
+        commandProcessed = processDriveModeCommand(command);
+    }
     #endif
     
     #if SUPPORT_SPEED_COMMANDS
-    if (!commandProcessed && (command.startsWith("F") || command.startsWith("B") || 
-                             command.startsWith("L") || command.startsWith("R"))) {
+    if (!commandProcessed && command.length() > 1 &&
+        (command.startsWith("F") || command.startsWith("B") || 
+         command.startsWith("L") || command.startsWith("R"))) {
         commandProcessed = processSpeedCommand(command);
     }
     #endif
@@ -184,9 +271,53 @@ void processBluetoothCommands() {
     }
     #endif
     
+    #if ENABLE_BLACKBOX
+    if (!commandProcessed && command == "END") {
+        commandProcessed = processMatchEndCommand();
+    }
+    #endif
+    
     if (!commandProcessed) {
         bluetooth.sendError("Invalid command: " + command);
         Serial.println("Invalid command: " + command);
+        return;
+    }
+    
+    markLinkAlive();
+}
+
+// Only an accepted command proves the controller is still there: noise,
+// corrupt packets and duplicates must not hold off the link-loss tiers
+void markLinkAlive() {
+    safety.resetCommunicationTimeout();
+    linkLoss.linkAlive();
+    lastCommandTime = millis();
+}
+
+void processRearmCommand() {
+    if (!bluetooth.hasCommand()) return;
+    
+    String command = bluetooth.readCommand();
+    command.trim();
+    
+    // A resent emergency packet is already satisfied: ACK it so the
+    // controller stops retrying
+    int sequence;
+    char cmdType;
+    String data;
+    if (command.startsWith("!") && bluetooth.parsePacket(command, sequence, cmdType, data) &&
+        sequence >= 0 && cmdType == CMD_EMERGENCY) {
+        bluetooth.sendAck(sequence);
+        return;
+    }
+    
+    // Everything except an explicit reset is dropped while stopped
+    if (command != "RESET" && command != "RST") return;
+    
+    if (safety.clearEmergencyStop()) {
+        bluetooth.sendStatus("REARMING");
+    } else {
+        bluetooth.sendError("E-stop still pressed");
     }
 }
 // ============================================================================
@@ -219,7 +350,7 @@ bool processSingleCharCommand(String command) {
             safety.triggerEmergencyStop();
             break;
         case '?':  // Status request
-            bluetooth.sendStatus(safety.getStatusString());
+            bluetooth.sendStatus(safety.getStatusString() + " " + linkMonitor.getStatusString());
             break;
         default:
             return false;
@@ -267,59 +398,101 @@ bool processSpeedCommand(String command) {
 }
 
 bool processDifferentialCommand(String command) {
-    // Format: M<leftSpeed><rightSpeed>
-    if (command.length() < 7) return false;  // Minimum: M000000
-    
-    String leftStr = command.substring(1, 4);
-    String rightStr = command.substring(4, 7);
+    // Format: M<axis1><axis2>, 000-254 each with 127 = stop
+    // Tank mode reads left/right, arcade and curvature read throttle/steering
+    int axis1, axis2;
+    if (!bluetooth.parseDifferential(command, axis1, axis2)) return false;
     
-    int leftSpeed = leftStr.toInt();
-    int rightSpeed = rightStr.toInt();
-    
-    // Handle negative speeds (would need different format in real implementation)
-    leftSpeed = constrain(leftSpeed, -255, 255);
-    rightSpeed = constrain(rightSpeed, -255, 255);
+    setMixedDrive(axis1, axis2);
+    return true;
+}
+
+bool processDriveModeCommand(String command) {
+    // Format: D<mode>, 0 = tank, 1 = arcade, 2 = curvature
+    uint8_t mode = command.charAt(1) - '0';
+    if (mode > DRIVE_MODE_CURVATURE) return false;
     
-    setMotorSpeeds(leftSpeed, rightSpeed);
+    driveMixer.setMode(mode);
+    stopAllMotors();  // Axes mean something else now
     
     #if DEBUG_MODE
-    Serial.print("Differential: L=");
-    Serial.print(leftSpeed);
-    Serial.print(" R=");
-    Serial.println(rightSpeed);
+    Serial.print("Drive mode: ");
+    Serial.println(mode);
     #endif
     
     return true;
 }
 bool processPacketCommand(String command) {
-    // Format: !<length><command><data><checksum>#
-    if (command.length() < 6) return false;
-    
-    // Validate checksum first
-    if (!bluetooth.validateChecksum(command)) {
+    // Format: !<length>[<seq>]<command><data><checksum>#
+    int sequence;
+    char cmdType;
+    String data;
+    if (!bluetooth.parsePacket(command, sequence, cmdType, data)) {
         bluetooth.sendError("Checksum mismatch");
         return false;
     }
     
-    // Extract command data
-    char cmdType = command.charAt(3);
-    String data = command.substring(4, command.length() - 3);
+    bool critical = BluetoothComm::isCriticalCommand(cmdType);
+    if (sequence >= 0) {
+        uint8_t verdict = linkMonitor.onPacket(sequence, critical);
+        
+        // Never run a command twice; a repeat means the ACK was lost
+        if (verdict == LINK_DUPLICATE) {
+            if (critical) bluetooth.sendAck(sequence);
+            return true;
+        }
+        
+        // A late or stale motion packet is older than what the motors are
+        // doing now; a critical one still runs and is ACKed
+        if (verdict != LINK_NEW && !critical) return true;
+    }
+    
+    if (!executePacketCommand(cmdType, data)) {
+        bluetooth.sendError("Invalid command: " + command);
+        Serial.println("Invalid command: " + command);
+        return false;
+    }
+    markLinkAlive();
+    
+    if (critical && sequence >= 0) {
+        bluetooth.sendAck(sequence);
+    }
+    return true;
+}
+
+bool executePacketCommand(char cmdType, String data) {
+    #if ENABLE_BLACKBOX
+    blackBox.noteCommand(cmdType);
+    #endif
     
     switch (cmdType) {
-        case 'M':  // Motor command
+        case 'M':  // Motor command, same axes as the plain M format
             if (data.length() >= 6) {
-                int leftSpeed = data.substring(0, 3).toInt();
-                int rightSpeed = data.substring(3, 6).toInt();
-                setMotorSpeeds(leftSpeed, rightSpeed);
+                setMixedDrive(BluetoothComm::decodeAxis(data.substring(0, 3).toInt()),
+                              BluetoothComm::decodeAxis(data.substring(3, 6).toInt()));
                 return true;
             }
             break;
+        case 'D':  // Drive mode
+            return processDriveModeCommand("D" + data);
         case 'S':  // Stop command
             stopAllMotors();
             return true;
+        case 'W':  // Weapon, data 1 = on: SafetySystem refuses it when unsafe
+            if (data.charAt(0) != '1') {
+                safety.stopWeapon();
+            } else if (safety.isWeaponSafe()) {
+                safety.startWeaponSpinup();
+            } else {
+                bluetooth.sendError("Weapon locked out");
+            }
+            return true;  // ACKed either way: a refusal is not a lost packet
         case 'E':  // Emergency stop
             safety.triggerEmergencyStop();
             return true;
+        case 'Q':  // Controller-side RSSI, data = -dBm
+            linkMonitor.updateSignalStrength(-data.toInt());
+            return true;
     }
     
     return false;
@@ -330,8 +503,7 @@ bool processPacketCommand(String command) {
 // ============================================================================
 
 void moveForward(int speed) {
-    leftMotor.setSpeed(speed);
-    rightMotor.setSpeed(speed);
+    linkLoss.command(speed, speed);
     
     #if DEBUG_MODE
     Serial.print("Moving forward at speed: ");
@@ -340,8 +512,7 @@ void moveForward(int speed) {
 }
 
 void moveBackward(int speed) {
-    leftMotor.setSpeed(-speed);
-    rightMotor.setSpeed(-speed);
+    linkLoss.command(-speed, -speed);
     
     #if DEBUG_MODE
     Serial.print("Moving backward at speed: ");
@@ -349,8 +520,7 @@ void moveBackward(int speed) {
     #endif
 }
 void turnLeft(int speed) {
-    leftMotor.setSpeed(-speed);
-    rightMotor.setSpeed(speed);
+    linkLoss.command(-speed, speed);
     
     #if DEBUG_MODE
     Serial.print("Turning left at speed: ");
@@ -359,8 +529,7 @@ void turnLeft(int speed) {
 }
 
 void turnRight(int speed) {
-    leftMotor.setSpeed(speed);
-    rightMotor.setSpeed(-speed);
+    linkLoss.command(speed, -speed);
     
     #if DEBUG_MODE
     Serial.print("Turning right at speed: ");
@@ -369,8 +538,7 @@ void turnRight(int speed) {
 }
 
 void setMotorSpeeds(int leftSpeed, int rightSpeed) {
-    leftMotor.setSpeed(leftSpeed);
-    rightMotor.setSpeed(rightSpeed);
+    linkLoss.command(leftSpeed, rightSpeed);
     
     #if DEBUG_MODE
     Serial.print("Motor speeds - Left: ");
@@ -380,7 +548,14 @@ void setMotorSpeeds(int leftSpeed, int rightSpeed) {
     #endif
 }
 
+void setMixedDrive(int axis1, int axis2) {
+    int16_t leftSpeed, rightSpeed;
+    driveMixer.mix(axis1, axis2, leftSpeed, rightSpeed);
+    setMotorSpeeds(leftSpeed, rightSpeed);
+}
+
 void stopAllMotors() {
+    linkLoss.stop();
     leftMotor.stop();
     rightMotor.stop();
     
@@ -393,13 +568,27 @@ void stopAllMotors() {
 // ============================================================================
 
 void emergencyStopHandler() {
-    // Interrupt service routine for emergency stop
+    // Interrupt service routine for emergency stop - register writes only,
+    // the status LED is left to SafetySystem::update()
     emergencyStopTriggered = true;
-    leftMotor.emergencyStop();
-    rightMotor.emergencyStop();
-    
-    // Flash LED to indicate emergency stop
-    digitalWrite(STATUS_LED_PIN, HIGH);
+    leftMotor.killFromISR();
+    rightMotor.killFromISR();
+}
+
+void rearmHandler() {
+    // E-stop released and held clear: motors accept commands again
+    emergencyStopTriggered = false;
+    leftMotor.clearEmergencyStop();
+    rightMotor.clearEmergencyStop();
+    linkLoss.stop();
+    digitalWrite(STATUS_LED_PIN, LOW);
+    bluetooth.sendStatus("REARMED");
+}
+
+void watchdogPreResetHook() {
+    // WDT interrupt: the loop is stuck, cut the motors before the reset
+    leftMotor.killFromISR();
+    rightMotor.killFromISR();
 }
 
 void handleSafetyViolation() {
@@ -422,9 +611,14 @@ void handleSafetyViolation() {
 }
 
 void updateMotorControl() {
-    // Update smooth motor control if enabled
-    // This function can be used for acceleration ramping in future
-    // Currently motors handle their own smooth control
+    // Movement commands only set the target: the link-loss policy holds it
+    // through short dropouts, decays it once the link stays quiet, and is
+    // the single place the drive motors are written from
+    int16_t leftSpeed, rightSpeed;
+    if (linkLoss.update(leftSpeed, rightSpeed)) {
+        leftMotor.setSpeed(leftSpeed);
+        rightMotor.setSpeed(rightSpeed);
+    }
 }
 
 void runMotorTest() {
@@ -436,6 +630,67 @@ void runMotorTest() {
     
     Serial.println(F("Motor test sequence complete"));
 }
+#if ENABLE_BLACKBOX
+// ============================================================================
+// BLACK-BOX RECORDER
+// ============================================================================
+
+void serviceBlackBox() {
+    // The e-stop edge is the event; the safety bits show how long it lasted
+    static bool wasEmergency = false;
+    bool emergency = safety.isEmergencyActive();
+    if (emergency && !wasEmergency) {
+        blackBox.event(BLACKBOX_EVENT_ESTOP);
+    }
+    wasEmergency = emergency;
+    
+    blackBox.record(leftMotor.getCurrentSpeed(), rightMotor.getCurrentSpeed(),
+                    getBlackBoxSafetyBits(),
+                    (uint16_t)(safety.getBatteryVoltage() * 1000.0));
+    
+    // At most one EEPROM byte write or one dump line per pass
+    blackBox.service();
+    processLogRequest();
+}
+
+uint8_t getBlackBoxSafetyBits() {
+    uint8_t bits = linkLoss.getTier() << BLACKBOX_SAFETY_TIER_SHIFT;
+    if (safety.isEmergencyActive())      bits |= BLACKBOX_SAFETY_ESTOP;
+    if (safety.isCommunicationTimeout()) bits |= BLACKBOX_SAFETY_TIMEOUT;
+    if (safety.isLowVoltage())           bits |= BLACKBOX_SAFETY_LOW_VOLTAGE;
+    if (safety.isCriticalVoltage())      bits |= BLACKBOX_SAFETY_CRITICAL;
+    if (safety.isWeaponSpunUp())         bits |= BLACKBOX_SAFETY_WEAPON;
+    if (safety.isLinkDegraded())         bits |= BLACKBOX_SAFETY_LINK;
+    return bits;
+}
+
+void processLogRequest() {
+    // "LOG" on the USB port starts a download; read without blocking
+    static char request[5];
+    static uint8_t length = 0;
+    
+    while (Serial.available() > 0) {
+        char c = Serial.read();
+        if (c == '\r' || c == '\n') {
+            request[length] = '\0';
+            if (strcmp(request, "LOG") == 0 && !blackBox.startDump(Serial)) {
+                Serial.println(F("BB BUSY"));
+            }
+            length = 0;
+        } else if (length < sizeof(request) - 1) {
+            request[length++] = c;
+        }
+    }
+}
+
+bool processMatchEndCommand() {
+    // Logged with the next sample, then committed to EEPROM in the background
+    blackBox.event(BLACKBOX_EVENT_MATCH_END);
+    bluetooth.sendStatus("MATCH END LOGGED");
+    return true;
+}
+#endif
+
 #if ENABLE_PERFORMANCE_MONITOR
 void updatePerformanceMetrics() {
     unsigned long loopTime = micros() - loopStartTime;
@@ -452,6 +707,12 @@ void updatePerformanceMetrics() {
         Serial.println(F(" microseconds"));
         
         safety.printStatus();
+        Serial.println(linkMonitor.getStatusString());
+        Serial.print(F("Link-loss tier: "));
+        Serial.println(linkLoss.getTierString());
+        #if ENABLE_BLACKBOX
+        Serial.println(blackBox.getStatusString());
+        #endif
         
         lastPerfPrint = millis();
         maxLoopTime = 0;  // Reset for next measurement period
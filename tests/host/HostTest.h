@@ -0,0 +1,42 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+/*
+ * Minimal host test harness
+ * Each test is a plain function; CHECK records failures without aborting
+ * so one run reports everything that broke.
+ */
+
+#include <stdio.h>
+
+static int _hostTestFailures = 0;
+static int _hostTestChecks = 0;
+
+#define CHECK(condition) do { \
+    _hostTestChecks++; \
+    if (!(condition)) { \
+        _hostTestFailures++; \
+        printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+    } \
+} while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+    _hostTestChecks++; \
+    long long _a = (long long)(actual), _e = (long long)(expected); \
+    if (_a != _e) { \
+        _hostTestFailures++; \
+        printf("  FAIL %s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, #actual, _a, _e); \
+    } \
+} while (0)
+
+#define RUN_TEST(test) do { \
+    int _before = _hostTestFailures; \
+    test(); \
+    printf("%s %s\n", _hostTestFailures == _before ? "PASS" : "FAIL", #test); \
+} while (0)
+
+#define TEST_RESULT() \
+    (printf("\n%d checks, %d failures\nRESULT: %s\n", _hostTestChecks, _hostTestFailures, \
+            _hostTestFailures ? "FAIL" : "PASS"), _hostTestFailures ? 1 : 0)
+
+#endif // HOST_TEST_H
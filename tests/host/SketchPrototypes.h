@@ -0,0 +1,108 @@
+#ifndef SKETCH_PROTOTYPES_H
+#define SKETCH_PROTOTYPES_H
+
+/*
+ * Sketch Prototypes (host)
+ * The Arduino builder generates a prototype for every function in a .ino
+ * file. The host tests include the sketch as plain C++, so they declare
+ * them here - one list per sketch, kept in step with the firmware.
+ *
+ * Define TEST_SKV3 (or BENCH_SKV3) for SKV3_CombatRobot_Main.ino,
+ * otherwise the list is for sumo_robot_main.ino. Include before the sketch.
+ */
+
+#include "Arduino.h"
+
+#if defined(TEST_SKV3) || defined(BENCH_SKV3)
+void hardwareEmergencyISR();
+void executeEmergencyShutdown();
+void serviceEmergencyStop();
+void executeSafetyTimeout();
+bool readBluetoothCommand(String &command);
+void processBluetoothCommand(String command);
+void processSingleCharCommand(char cmd);
+void processAdvancedCommand(String cmd);
+void processPacketCommand(String packet);
+void moveForward();
+void moveBackward();
+void turnLeft();
+void turnRight();
+void stopMovement();
+void attackMove();
+void setDifferentialDrive(int axis1, int axis2);
+void setDriveMode(int mode);
+int decodeAxis(int field);
+int scaleQ8(int value, unsigned int gain);
+unsigned int curvatureGain(int speed);
+void buildExpoCurve(uint16_t *curve, uint8_t expoPercent);
+int applyCurve(const uint16_t *curve, int value);
+void mixDrive(int axis1, int axis2, int &leftSpeed, int &rightSpeed);
+bool packetChecksumValid(String packet);
+int packetSequence(String packet);
+bool isCriticalCommand(char command);
+void sendAck(uint8_t sequence);
+uint8_t linkAccept(uint8_t sequence, bool critical);
+void linkRecordLoss(uint8_t count);
+void linkRecordArrival(uint8_t steps);
+void linkFlagBurst();
+bool linkDegraded();
+uint8_t linkPercent(unsigned long count);
+void reportLinkStatus();
+void setBothMotors(int leftSpeed, int rightSpeed);
+void toggleWeapon();
+void heartbeat(uint8_t task);
+uint8_t staleTasks();
+void serviceWatchdog();
+void enableWatchdog();
+void reportResetCause();
+void killOutputsFromISR();
+void updateMotorSystems();
+int slewTowardsZero(int speed, int step);
+void updateStatusIndicators();
+void testMotorSystems();
+void blackBoxBegin(uint8_t resetFlags);
+void blackBoxEvent(uint8_t event);
+void serviceBlackBox();
+uint8_t blackBoxSafetyBits();
+void blackBoxRecord();
+void blackBoxAppend(const uint8_t *bytes, uint8_t length);
+uint16_t blackBoxTail();
+void blackBoxSeal();
+uint8_t blackBoxRecordLength(uint8_t type);
+bool blackBoxRingValid();
+uint8_t blackBoxEepromRead(uint16_t address);
+bool blackBoxCommitByte(uint16_t step, uint16_t &address, uint8_t &value);
+void blackBoxServiceCommit();
+void blackBoxServiceDump();
+void processLogRequest();
+#else
+void processBluetoothCommands();
+void markLinkAlive();
+void processRearmCommand();
+bool processSingleCharCommand(String command);
+bool processSpeedCommand(String command);
+bool processDifferentialCommand(String command);
+bool processDriveModeCommand(String command);
+bool processPacketCommand(String command);
+bool executePacketCommand(char cmdType, String data);
+void moveForward(int speed);
+void moveBackward(int speed);
+void turnLeft(int speed);
+void turnRight(int speed);
+void setMotorSpeeds(int leftSpeed, int rightSpeed);
+void setMixedDrive(int axis1, int axis2);
+void stopAllMotors();
+void emergencyStopHandler();
+void rearmHandler();
+void watchdogPreResetHook();
+void handleSafetyViolation();
+void updateMotorControl();
+void runMotorTest();
+void serviceBlackBox();
+uint8_t getBlackBoxSafetyBits();
+void processLogRequest();
+bool processMatchEndCommand();
+void updatePerformanceMetrics();
+#endif
+
+#endif // SKETCH_PROTOTYPES_H
@@ -0,0 +1,557 @@
+/*
+ * Black-Box Recorder Test (host)
+ * Runs BlackBox against the simulated EEPROM and UART and decodes what it
+ * produced with the PC tool's decoder: samples round-trip exactly, the
+ * ring wraps on record boundaries, EEPROM is only written on events and
+ * at most one byte per loop pass, commits rotate across slots, a commit
+ * cut short leaves the previous log intact, and the ring survives a
+ * watchdog reset.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -I tests/host/hal -I . tests/host/blackbox_test.cpp \
+ *       tests/host/hal/HostHal.cpp src/BlackBox.cpp -o blackbox_test
+ *   ./blackbox_test
+ *
+ * Add -DTEST_SKV3 and build only this file plus HostHal.cpp to drive
+ * SKV3_CombatRobot_Main.ino instead, which carries its own recorder: its
+ * e-stop and match-end slots, downloaded with "LOG", must decode to exactly
+ * what it recorded.
+ */
+
+#include <sstream>
+#include <map>
+#include "HostHal.h"
+#include "HostTest.h"
+
+#ifdef TEST_SKV3
+#include "SoftwareSerial.h"
+#include "SketchPrototypes.h"
+#include "../../src/SKV3_CombatRobot_Main.ino"
+#else
+#include "config/robot_config.h"
+#include "include/BlackBox.h"
+#endif
+#include "tools/BlackBoxLog.h"
+
+#define TEST_LOOP_PERIOD_US   10000     // Simulated loop period, a slow loop
+#define TEST_PASS_BUDGET_US   100       // service() must never wait on the EEPROM or UART
+#define TEST_SLOT_BYTES       (BLACKBOX_SLOT_HEADER_BYTES + BLACKBOX_RING_BYTES)
+
+#ifndef TEST_SKV3
+
+// What the robot was doing at time t (ms): a ramp with reversals, a jump
+// too big for a delta, safety bits and battery sag, a command every second
+static int16_t _left(unsigned long t)   { return t < 3000 ? (int16_t)(t / 20) : (t < 3500 ? -255 : 80); }
+static int16_t _right(unsigned long t)  { return (int16_t)((t / 50) % 40) * 3 - 60; }
+static uint8_t _safety(unsigned long t) { return (t / 1500) % 2 ? BLACKBOX_SAFETY_WEAPON : 0; }
+static uint16_t _battery(unsigned long t) { return 12600 - t / 10; }
+static char _command(unsigned long t)   { return t % 1000 == 0 ? 'A' + (t / 1000) % 26 : 0; }
+
+// One loop pass: note the command, sample, background work
+static void _loopOnce(BlackBox& box) {
+    unsigned long t = millis();
+    if (_command(t)) box.noteCommand(_command(t));
+    box.record(_left(t), _right(t), _safety(t), _battery(t));
+    box.service();
+    hostAdvanceMicros(TEST_LOOP_PERIOD_US);
+}
+
+static void _runFor(BlackBox& box, unsigned long ms) {
+    for (unsigned long i = 0; i < ms * 1000UL / TEST_LOOP_PERIOD_US; i++) _loopOnce(box);
+}
+
+// Fresh power-on: clean EEPROM, RAM ring discarded
+static void _powerOn(BlackBox& box) {
+    hostReset();
+    hostEepromErase();
+    Serial.begin(9600);
+    box.begin(_BV(PORF));
+}
+
+static void _finishCommit(BlackBox& box) {
+    for (int i = 0; i < 10000 && box.isCommitting(); i++) {
+        box.service();
+        hostAdvanceMicros(TEST_LOOP_PERIOD_US);
+    }
+}
+
+// Download over Serial exactly as tools/blackbox_dump would
+static bool _download(BlackBox& box, blackbox::Dump& dump, uint64_t* worstPass = nullptr) {
+    Serial.hostClearTransmitted();
+    if (!box.startDump(Serial)) return false;
+    if (worstPass) *worstPass = 0;
+    for (int i = 0; i < 10000 && box.isDumping(); i++) {
+        uint64_t start = hostNowCycles();
+        box.service();
+        if (worstPass && hostNowCycles() - start > *worstPass) *worstPass = hostNowCycles() - start;
+        hostAdvanceMicros(TEST_LOOP_PERIOD_US);
+    }
+    std::istringstream in(Serial.hostTransmitted());
+    return blackbox::parseDump(in, dump);
+}
+
+// Every decoded sample (each repeat of an idle run too) matches the input
+static bool _matchesInput(const std::vector<blackbox::Sample>& samples) {
+    for (const blackbox::Sample& sample : samples) {
+        for (uint8_t i = 0; i < sample.repeat; i++) {
+            unsigned long t = sample.time + i * BLACKBOX_SAMPLE_MS;
+            if (sample.left != _left(t) || sample.right != _right(t) || sample.safety != _safety(t) ||
+                sample.batteryMv != _battery(t) / BLACKBOX_BATTERY_STEP_MV * BLACKBOX_BATTERY_STEP_MV ||
+                sample.command != (i == 0 ? _command(t) : 0)) {
+                printf("  mismatch at t=%lu\n", t);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static unsigned long _sampleCount(const std::vector<blackbox::Sample>& samples) {
+    unsigned long count = 0;
+    for (const blackbox::Sample& sample : samples) count += sample.repeat;
+    return count;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+static void testSamplesRoundTrip() {
+    BlackBox box;
+    _powerOn(box);
+    _runFor(box, 2000);
+
+    blackbox::Dump dump;
+    CHECK(_download(box, dump));
+    size_t skipped = 1;
+    std::vector<blackbox::Sample> samples = blackbox::decode(dump.ram, dump.sampleMs, &skipped);
+
+    CHECK_EQ(skipped, 0);
+    CHECK_EQ(samples.front().time, 0);
+    CHECK_EQ(_sampleCount(samples), 2000 / BLACKBOX_SAMPLE_MS);
+    CHECK(_matchesInput(samples));
+}
+
+static void testIdleIsCompact() {
+    BlackBox box;
+    _powerOn(box);
+
+    // Parked: one keyframe per BLACKBOX_KEYFRAME_SAMPLES, idle runs between
+    for (int i = 0; i < 200; i++) {
+        box.record(0, 0, 0, 12000);
+        hostAdvanceMicros(TEST_LOOP_PERIOD_US);
+    }
+    unsigned long samples = 200 * TEST_LOOP_PERIOD_US / 1000 / BLACKBOX_SAMPLE_MS;
+    unsigned long keyframes = (samples + BLACKBOX_KEYFRAME_SAMPLES - 1) / BLACKBOX_KEYFRAME_SAMPLES;
+    CHECK_EQ(box.getUsed(), keyframes * (BLACKBOX_KEYFRAME_BYTES + 1));
+}
+
+static void testRingWrapsOnRecordBoundaries() {
+    BlackBox box;
+    _powerOn(box);
+    _runFor(box, 20000);
+    CHECK(box.getUsed() <= BLACKBOX_RING_BYTES);
+    CHECK(box.getUsed() > BLACKBOX_RING_BYTES - BLACKBOX_KEYFRAME_BYTES);
+
+    blackbox::Dump dump;
+    CHECK(_download(box, dump));
+    std::vector<blackbox::Sample> samples = blackbox::decode(dump.ram, dump.sampleMs);
+
+    // Oldest records are gone, the newest are exact up to the last sample
+    CHECK(samples.front().time > 0);
+    CHECK(_matchesInput(samples));
+    const blackbox::Sample& last = samples.back();
+    CHECK_EQ(last.time + (last.repeat - 1) * BLACKBOX_SAMPLE_MS, 20000 - BLACKBOX_SAMPLE_MS);
+}
+
+static void testNoEepromWritesWithoutEvent() {
+    BlackBox box;
+    _powerOn(box);
+    _runFor(box, 30000);
+
+    CHECK_EQ(hostEepromTotalWrites(), 0);
+    CHECK(!box.isCommitting());
+}
+
+static void testCommitIsBoundedPerPass() {
+    BlackBox box;
+    _powerOn(box);
+    _runFor(box, 5000);
+    box.event(BLACKBOX_EVENT_ESTOP);
+
+    // Every pass: at most one byte written, never waiting for the last one
+    uint64_t worst = 0;
+    unsigned long passes = 0;
+    bool bounded = true;
+    for (int i = 0; i < 10000; i++) {
+        unsigned long writes = hostEepromTotalWrites();
+        uint64_t start = hostNowCycles();
+        _loopOnce(box);
+        uint64_t cost = hostNowCycles() - start - hostMicrosToCycles(TEST_LOOP_PERIOD_US);
+        if (cost > worst) worst = cost;
+        if (hostEepromTotalWrites() - writes > 1) bounded = false;
+        if (box.isCommitting()) passes++;
+        else if (box.getCommits() > 0) break;
+    }
+    printf("  commit: %lu passes, worst pass %.1f us\n", passes, hostCyclesToMicros(worst));
+
+    CHECK(bounded);
+    CHECK(hostCyclesToMicros(worst) < TEST_PASS_BUDGET_US);
+    CHECK_EQ(box.getCommits(), 1);
+
+    blackbox::Dump dump;
+    CHECK(_download(box, dump));
+    std::vector<blackbox::Slot> slots = blackbox::parseSlots(dump);
+    CHECK_EQ(slots.size(), 1);
+    CHECK_EQ(slots[0].reason, BLACKBOX_EVENT_ESTOP);
+    CHECK(slots[0].checksumOk);
+
+    // The event is the last sample in the saved log
+    std::vector<blackbox::Sample> samples = blackbox::decode(slots[0].data, dump.sampleMs);
+    CHECK_EQ(samples.back().event, BLACKBOX_EVENT_ESTOP);
+    CHECK(_matchesInput(samples));
+}
+
+static void testSlotsRotate() {
+    BlackBox box;
+    _powerOn(box);
+
+    const uint8_t reasons[] = { BLACKBOX_EVENT_ESTOP, BLACKBOX_EVENT_MATCH_END, BLACKBOX_EVENT_ESTOP,
+                                BLACKBOX_EVENT_MATCH_END, BLACKBOX_EVENT_ESTOP, BLACKBOX_EVENT_MATCH_END };
+    for (uint8_t reason : reasons) {
+        _runFor(box, 3000);
+        box.event(reason);
+        _runFor(box, 100);
+        _finishCommit(box);
+    }
+    CHECK_EQ(box.getCommits(), 6);
+
+    // Two commits per slot: the first-byte of each magic written at most
+    // three times (write, invalidate, write)
+    for (uint8_t slot = 0; slot < BLACKBOX_EEPROM_SLOTS; slot++) {
+        uint16_t base = BLACKBOX_EEPROM_START + slot * TEST_SLOT_BYTES;
+        CHECK(hostEepromWrites(base) > 0);
+        CHECK(hostEepromWrites(base) <= 3);
+    }
+
+    blackbox::Dump dump;
+    CHECK(_download(box, dump));
+    std::vector<blackbox::Slot> slots = blackbox::parseSlots(dump);
+    CHECK_EQ(slots.size(), BLACKBOX_EEPROM_SLOTS);
+    CHECK_EQ(slots[0].sequence, 6);
+    CHECK_EQ(slots[0].reason, BLACKBOX_EVENT_MATCH_END);
+    CHECK_EQ(slots[1].sequence, 5);
+    CHECK_EQ(slots[2].sequence, 4);
+}
+
+static void testInterruptedCommitKeepsPreviousLog() {
+    BlackBox box;
+    _powerOn(box);
+    _runFor(box, 3000);
+    box.event(BLACKBOX_EVENT_MATCH_END);
+    _runFor(box, 100);
+    _finishCommit(box);
+
+    // Power lost part way through the next commit
+    _runFor(box, 3000);
+    box.event(BLACKBOX_EVENT_ESTOP);
+    for (int i = 0; i < 30; i++) _loopOnce(box);
+    CHECK(box.isCommitting());
+
+    BlackBox rebooted;
+    hostReset();
+    Serial.begin(9600);
+    rebooted.begin(_BV(PORF));
+
+    blackbox::Dump dump;
+    CHECK(_download(rebooted, dump));
+    std::vector<blackbox::Slot> slots = blackbox::parseSlots(dump);
+    CHECK_EQ(slots.size(), 1);
+    CHECK_EQ(slots[0].reason, BLACKBOX_EVENT_MATCH_END);
+    CHECK(slots[0].checksumOk);
+
+    // The half-written slot is the next one used, the good log stays
+    rebooted.event(BLACKBOX_EVENT_ESTOP);
+    _runFor(rebooted, 100);
+    _finishCommit(rebooted);
+    CHECK(_download(rebooted, dump));
+    slots = blackbox::parseSlots(dump);
+    CHECK_EQ(slots.size(), 2);
+    CHECK_EQ(slots[0].sequence, 2);
+    CHECK_EQ(slots[0].index, 1);
+    CHECK_EQ(slots[1].reason, BLACKBOX_EVENT_MATCH_END);
+}
+
+static void testWatchdogResetRecoversRing() {
+    BlackBox box;
+    _powerOn(box);
+    _runFor(box, 4000);
+    uint16_t used = box.getUsed();
+    unsigned long hungAt = millis();
+
+    // Watchdog reset: the ring is still in .noinit RAM and gets saved
+    BlackBox rebooted;
+    rebooted.begin(_BV(WDRF));
+    CHECK_EQ(rebooted.getRecovered(), used);
+    _runFor(rebooted, 100);
+    _finishCommit(rebooted);
+    CHECK_EQ(rebooted.getCommits(), 1);
+
+    blackbox::Dump dump;
+    CHECK(_download(rebooted, dump));
+    std::vector<blackbox::Slot> slots = blackbox::parseSlots(dump);
+    CHECK_EQ(slots.size(), 1);
+    CHECK_EQ(slots[0].reason, BLACKBOX_EVENT_WATCHDOG);
+
+    // What led up to the hang, then the reboot marked with the event
+    std::vector<blackbox::Sample> samples = blackbox::decode(slots[0].data, dump.sampleMs);
+    CHECK(samples.front().time < hungAt);
+    CHECK(_matchesInput(samples));
+    CHECK_EQ(samples.back().event, BLACKBOX_EVENT_WATCHDOG);
+    CHECK(samples.back().time >= hungAt);
+
+    // Power-on RAM is never trusted
+    BlackBox powered;
+    powered.begin(_BV(PORF));
+    CHECK_EQ(powered.getRecovered(), 0);
+    CHECK_EQ(powered.getUsed(), 0);
+}
+
+static void testDumpNeverBlocks() {
+    BlackBox box;
+    _powerOn(box);
+    _runFor(box, 20000);
+
+    blackbox::Dump dump;
+    uint64_t worst = 0;
+    CHECK(_download(box, dump, &worst));
+    printf("  dump: worst pass %.1f us\n", hostCyclesToMicros(worst));
+    CHECK(hostCyclesToMicros(worst) < TEST_PASS_BUDGET_US);
+    CHECK_EQ(dump.eeprom.size(), BLACKBOX_EEPROM_SLOTS * TEST_SLOT_BYTES);
+    CHECK_EQ(dump.ram.size(), box.getUsed());
+
+    // No download while a commit owns the ring
+    box.event(BLACKBOX_EVENT_MATCH_END);
+    _runFor(box, 100);
+    CHECK(box.isCommitting());
+    CHECK(!box.startDump(Serial));
+}
+
+#else
+// ============================================================================
+// SKV3 SKETCH HELPERS
+// ============================================================================
+
+#define TEST_BAUD             9600
+#define TEST_USB_BAUD         115200
+#define TEST_COMMAND_MS       40        // Controller resend interval while driving
+#define TEST_GIVE_UP_MS       10000     // A commit or download never takes this long
+
+// What the recorder encoded for each sample time
+struct Recorded {
+    int left;
+    int right;
+    uint8_t safety;
+};
+
+static std::map<unsigned long, Recorded> _recorded;
+static Stream* _port = nullptr;
+
+// One loop() pass; when the recorder takes a sample, note what it encoded
+static void _loopOnce() {
+    bool paused = blackBox.committing || blackBox.dumping;
+    unsigned long lastSample = blackBox.lastSample;
+    loop();
+    hostAdvanceCycles(200);
+    if (!paused && blackBox.lastSample != lastSample) {
+        Recorded sample = { blackBox.lastLeft, blackBox.lastRight, blackBox.lastSafety };
+        _recorded[blackBox.lastSample] = sample;
+    }
+}
+
+static void _runFor(unsigned long ms) {
+    uint64_t until = hostNowCycles() + hostMicrosToCycles(ms * 1000UL);
+    while (hostNowCycles() < until) _loopOnce();
+}
+
+static void _send(const char* command) {
+    _port->hostInject(command, strlen(command), TEST_BAUD, hostNowCycles());
+    _runFor(30);
+}
+
+// A held button on the controller: the command resent until released
+static void _drive(const char* command, unsigned long ms) {
+    for (unsigned long t = 0; t < ms; t += TEST_COMMAND_MS) {
+        _port->hostInject(command, strlen(command), TEST_BAUD, hostNowCycles());
+        _runFor(TEST_COMMAND_MS);
+    }
+}
+
+static bool _waitForSave() {
+    uint64_t giveUp = hostNowCycles() + hostMicrosToCycles(TEST_GIVE_UP_MS * 1000UL);
+    while (blackBox.committing && hostNowCycles() < giveUp) _loopOnce();
+    return !blackBox.committing;
+}
+
+// "LOG" on the USB port, read back exactly as tools/blackbox_dump would
+static bool _download(blackbox::Dump& dump) {
+    std::string received;
+    Serial.hostClearTransmitted();
+    Serial.hostInject("LOG\n", 4, TEST_USB_BAUD, hostNowCycles());
+
+    uint64_t giveUp = hostNowCycles() + hostMicrosToCycles(TEST_GIVE_UP_MS * 1000UL);
+    while (received.find("BB END") == std::string::npos && hostNowCycles() < giveUp) {
+        _loopOnce();
+        received += Serial.hostTransmitted();
+        Serial.hostClearTransmitted();
+    }
+    dump = blackbox::Dump();
+    std::istringstream in(received);
+    return blackbox::parseDump(in, dump);
+}
+
+static unsigned long _sampleCount(const std::vector<blackbox::Sample>& samples) {
+    unsigned long count = 0;
+    for (const blackbox::Sample& sample : samples) count += sample.repeat;
+    return count;
+}
+
+// Every decoded sample (each repeat of an idle run too) is what the sketch
+// recorded at that time, and none it recorded in that span is missing
+static bool _matchesRecorded(const std::vector<blackbox::Sample>& samples, uint16_t sampleMs) {
+    if (samples.empty()) return false;
+    for (const blackbox::Sample& sample : samples) {
+        for (uint8_t i = 0; i < sample.repeat; i++) {
+            unsigned long t = sample.time + (unsigned long)i * sampleMs;
+            std::map<unsigned long, Recorded>::const_iterator at = _recorded.find(t);
+            if (at == _recorded.end() || sample.left != at->second.left ||
+                sample.right != at->second.right || sample.safety != at->second.safety) {
+                printf("  mismatch at t=%lu\n", t);
+                return false;
+            }
+        }
+    }
+
+    const blackbox::Sample& last = samples.back();
+    unsigned long end = last.time + (unsigned long)(last.repeat - 1) * sampleMs;
+    unsigned long span = 0;
+    for (std::map<unsigned long, Recorded>::const_iterator at = _recorded.lower_bound(samples.front().time);
+         at != _recorded.end() && at->first <= end; ++at) {
+        span++;
+    }
+    return span == _sampleCount(samples);
+}
+
+static bool _hasCommand(const std::vector<blackbox::Sample>& samples, char command) {
+    for (const blackbox::Sample& sample : samples) {
+        if (sample.command == command) return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// SKV3 SKETCH TESTS
+// ============================================================================
+
+static void testSketchEstopSlotDecodes() {
+    _drive("F\n", 600);
+    _drive("L\n", 400);
+    CHECK(blackBox.lastLeft < 0 && blackBox.lastRight > 0);
+
+    hostSetInput(EMERGENCY_STOP_PIN, LOW);
+    _runFor(BLACKBOX_SAMPLE_MS * 2);
+    CHECK(_waitForSave());
+    CHECK_EQ(hostEepromWrites(BLACKBOX_EEPROM_START), 1);
+
+    blackbox::Dump dump;
+    CHECK(_download(dump));
+    CHECK_EQ(dump.eepromStart, BLACKBOX_EEPROM_START);
+    CHECK_EQ(dump.slots, BLACKBOX_EEPROM_SLOTS);
+    CHECK_EQ(dump.slotBytes, TEST_SLOT_BYTES);
+    CHECK_EQ(dump.sampleMs, BLACKBOX_SAMPLE_MS);
+
+    std::vector<blackbox::Slot> slots = blackbox::parseSlots(dump);
+    CHECK_EQ(slots.size(), 1);
+    if (slots.size() != 1) return;
+    CHECK_EQ(slots[0].index, 0);
+    CHECK_EQ(slots[0].reason, BLACKBOX_EVENT_ESTOP);
+    CHECK(slots[0].checksumOk);
+
+    // The whole drive since power-on, ending on the e-stop
+    size_t skipped = 1;
+    std::vector<blackbox::Sample> samples = blackbox::decode(slots[0].data, dump.sampleMs, &skipped);
+    CHECK_EQ(skipped, 0);
+    CHECK(_matchesRecorded(samples, dump.sampleMs));
+    CHECK_EQ(samples.front().time, _recorded.begin()->first);
+    CHECK(_hasCommand(samples, 'F'));
+    CHECK(_hasCommand(samples, 'L'));
+    CHECK_EQ(samples.back().event, BLACKBOX_EVENT_ESTOP);
+    CHECK(samples.back().safety & BLACKBOX_SAFETY_ESTOP);
+    CHECK_EQ(samples.back().left, 0);
+
+    // The live ring decodes too
+    CHECK(_matchesRecorded(blackbox::decode(dump.ram, dump.sampleMs), dump.sampleMs));
+}
+
+static void testSketchMatchEndRotatesSlot() {
+    hostSetInput(EMERGENCY_STOP_PIN, HIGH);
+    _runFor(20);
+    _send("RESET\n");
+    _runFor(ESTOP_REARM_HOLD_MS + 50);
+
+    _drive("B\n", 500);
+    _send("END\n");
+    _runFor(BLACKBOX_SAMPLE_MS * 2);
+    CHECK(_waitForSave());
+
+    blackbox::Dump dump;
+    CHECK(_download(dump));
+    std::vector<blackbox::Slot> slots = blackbox::parseSlots(dump);
+    CHECK_EQ(slots.size(), 2);
+    if (slots.size() != 2) return;
+
+    // Newest first, in the next slot; the e-stop log is untouched
+    CHECK_EQ(slots[0].index, 1);
+    CHECK_EQ(slots[0].sequence, slots[1].sequence + 1);
+    CHECK_EQ(slots[0].reason, BLACKBOX_EVENT_MATCH_END);
+    CHECK_EQ(slots[1].reason, BLACKBOX_EVENT_ESTOP);
+    CHECK(slots[0].checksumOk);
+    CHECK(slots[1].checksumOk);
+
+    std::vector<blackbox::Sample> samples = blackbox::decode(slots[0].data, dump.sampleMs);
+    CHECK(_matchesRecorded(samples, dump.sampleMs));
+    CHECK(_hasCommand(samples, 'B'));
+    CHECK_EQ(samples.back().event, BLACKBOX_EVENT_MATCH_END);
+    CHECK(samples.back().left < 0);
+}
+#endif
+
+int main() {
+    #ifdef TEST_SKV3
+    hostReset();
+    hostEepromErase();
+    setup();
+    _port = hostSoftwareSerial(BT_RX_PIN);
+    if (!_port) {
+        printf("No SoftwareSerial on pin %d\n", BT_RX_PIN);
+        return 2;
+    }
+    printf("Target: SKV3_CombatRobot_Main.ino\n");
+
+    // Order matters: the second slot is committed after the first
+    RUN_TEST(testSketchEstopSlotDecodes);
+    RUN_TEST(testSketchMatchEndRotatesSlot);
+    #else
+    RUN_TEST(testSamplesRoundTrip);
+    RUN_TEST(testIdleIsCompact);
+    RUN_TEST(testRingWrapsOnRecordBoundaries);
+    RUN_TEST(testNoEepromWritesWithoutEvent);
+    RUN_TEST(testCommitIsBoundedPerPass);
+    RUN_TEST(testSlotsRotate);
+    RUN_TEST(testInterruptedCommitKeepsPreviousLog);
+    RUN_TEST(testWatchdogResetRecoversRing);
+    RUN_TEST(testDumpNeverBlocks);
+    #endif
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,336 @@
+/*
+ * Drive Mixer Test (host)
+ * Checks DriveMixer outputs for tank, arcade and curvature modes, the expo
+ * LUTs, turn-ratio-preserving saturation and the offset-127 M field decode.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -I tests/host/hal -I . tests/host/drive_mixer_test.cpp \
+ *       tests/host/hal/HostHal.cpp src/DriveMixer.cpp src/BluetoothComm.cpp \
+ *       -o drive_mixer_test
+ *   ./drive_mixer_test
+ *
+ * Add -DTEST_SKV3 and build only this file plus HostHal.cpp to run the same
+ * cases against the mixer inlined in SKV3_CombatRobot_Main.ino.
+ */
+
+#include "HostHal.h"
+#include "HostTest.h"
+
+// ============================================================================
+// MIXER UNDER TEST
+// ============================================================================
+
+#ifdef TEST_SKV3
+#include "SketchPrototypes.h"
+#include "../../src/SKV3_CombatRobot_Main.ino"
+
+#define TEST_TARGET              "SKV3_CombatRobot_Main.ino"
+#define TEST_DECODE_AXIS(field)  decodeAxis(field)
+
+// The sketch mixes from globals with gains fixed at build time. Give it the
+// DriveMixer interface so the cases below run against it unchanged; gain
+// cases that need setGains() are class-only.
+class DriveMixer {
+public:
+    DriveMixer() {
+        driveMode = DRIVE_MODE_DEFAULT;
+        setExpo(DRIVE_THROTTLE_EXPO, DRIVE_STEERING_EXPO);
+    }
+
+    void setMode(uint8_t mode) { setDriveMode(mode); }
+    uint8_t getMode() const { return driveMode; }
+
+    void setExpo(uint8_t throttleExpo, uint8_t steeringExpo) {
+        buildExpoCurve(throttleCurve, throttleExpo);
+        buildExpoCurve(steeringCurve, steeringExpo);
+    }
+
+    void mix(int16_t axis1, int16_t axis2, int16_t &left, int16_t &right) const {
+        int leftSpeed, rightSpeed;
+        mixDrive(axis1, axis2, leftSpeed, rightSpeed);
+        left = leftSpeed;
+        right = rightSpeed;
+    }
+
+    int16_t applyThrottleCurve(int16_t value) const { return applyCurve(throttleCurve, value); }
+    int16_t applySteeringCurve(int16_t value) const { return applyCurve(steeringCurve, value); }
+};
+#else
+#include "config/robot_config.h"
+#include "include/DriveMixer.h"
+#include "include/BluetoothComm.h"
+
+#define TEST_TARGET              "DriveMixer"
+#define TEST_DECODE_AXIS(field)  BluetoothComm::decodeAxis(field)
+#endif
+
+// Mix with a fresh mixer in the given mode and default tuning
+static void _mix(uint8_t mode, int16_t axis1, int16_t axis2, int16_t &left, int16_t &right) {
+    DriveMixer mixer;
+    mixer.setMode(mode);
+    mixer.mix(axis1, axis2, left, right);
+}
+
+// Turn ratio inner/outer in percent, for comparing before and after saturation
+static long _ratio(int16_t inner, int16_t outer) {
+    return (long)inner * 100 / outer;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+static void testDefaults() {
+    DriveMixer mixer;
+    CHECK_EQ(mixer.getMode(), DRIVE_MODE_DEFAULT);
+
+    int16_t left, right;
+    for (uint8_t mode = DRIVE_MODE_TANK; mode <= DRIVE_MODE_CURVATURE; mode++) {
+        _mix(mode, 0, 0, left, right);
+        CHECK_EQ(left, 0);
+        CHECK_EQ(right, 0);
+    }
+}
+
+static void testTankPassthrough() {
+    int16_t left, right;
+
+    // Unity differential gain and linear throttle: sides pass straight through
+    _mix(DRIVE_MODE_TANK, 200, -120, left, right);
+    CHECK_EQ(left, 200);
+    CHECK_EQ(right, -120);
+
+    _mix(DRIVE_MODE_TANK, 255, 255, left, right);
+    CHECK_EQ(left, 255);
+    CHECK_EQ(right, 255);
+
+    _mix(DRIVE_MODE_TANK, -255, 255, left, right);
+    CHECK_EQ(left, -255);
+    CHECK_EQ(right, 255);
+}
+
+#ifndef TEST_SKV3
+static void testTankDifferentialGain() {
+    DriveMixer mixer;
+    mixer.setMode(DRIVE_MODE_TANK);
+    int16_t left, right;
+
+    // Half gain halves the side difference around the mean
+    mixer.setGains(128, TURN_RATE_MULTIPLIER);
+    mixer.mix(200, 100, left, right);
+    CHECK_EQ(left, 175);
+    CHECK_EQ(right, 125);
+
+    // Straight driving is untouched by the gain
+    mixer.mix(150, 150, left, right);
+    CHECK_EQ(left, 150);
+    CHECK_EQ(right, 150);
+}
+#endif
+
+static void testArcadeTurnRate() {
+    DriveMixer mixer;
+    mixer.setMode(DRIVE_MODE_ARCADE);
+    mixer.setExpo(0, 0);
+    int16_t left, right;
+
+    // Pure throttle drives straight
+    mixer.mix(150, 0, left, right);
+    CHECK_EQ(left, 150);
+    CHECK_EQ(right, 150);
+
+    // Turn is scaled by TURN_RATE_MULTIPLIER (0.8)
+    mixer.mix(0, 100, left, right);
+    CHECK_EQ(left, (100 * TURN_RATE_MULTIPLIER) >> 8);
+    CHECK_EQ(right, -((100 * TURN_RATE_MULTIPLIER) >> 8));
+
+    // Left and right steering are mirror images
+    int16_t mirroredLeft, mirroredRight;
+    mixer.mix(120, 80, left, right);
+    mixer.mix(120, -80, mirroredLeft, mirroredRight);
+    CHECK_EQ(left, mirroredRight);
+    CHECK_EQ(right, mirroredLeft);
+    CHECK(left > right);
+}
+
+static void testSaturationKeepsTurnRatio() {
+    DriveMixer mixer;
+    mixer.setMode(DRIVE_MODE_ARCADE);
+    mixer.setExpo(0, 0);
+    int16_t left, right;
+
+    #ifdef TEST_SKV3
+    // Build-time 0.8 turn rate: 200 +/- 80 would be 280/120; clipping only
+    // the fast side would give 255/120. Scaling both keeps the ratio.
+    mixer.mix(200, 100, left, right);
+    CHECK_EQ(left, 255);
+    CHECK_EQ(right, 109);
+    CHECK_EQ(_ratio(right, left), _ratio(120, 280));
+    #else
+    mixer.setGains(DIFFERENTIAL_GAIN, 256);
+
+    // 200 +/- 100 would be 300/100; clipping only the fast side would give
+    // 255/100. Scaling both keeps the 3:1 ratio.
+    mixer.mix(200, 100, left, right);
+    CHECK_EQ(left, 255);
+    CHECK(right > 80 && right < 90);
+    CHECK_EQ(_ratio(right, left), 33);
+
+    // Full throttle and full steering spins the slow side to a stop, not reverse
+    mixer.mix(255, 255, left, right);
+    CHECK_EQ(left, 255);
+    CHECK_EQ(right, 0);
+    #endif
+
+    // Nothing ever leaves the PWM range
+    for (int16_t a = -255; a <= 255; a += 15) {
+        for (int16_t b = -255; b <= 255; b += 15) {
+            for (uint8_t mode = DRIVE_MODE_TANK; mode <= DRIVE_MODE_CURVATURE; mode++) {
+                mixer.setMode(mode);
+                mixer.mix(a, b, left, right);
+                CHECK(left >= -255 && left <= 255);
+                CHECK(right >= -255 && right <= 255);
+            }
+        }
+    }
+}
+
+static void testCurvatureFollowsThrottle() {
+    DriveMixer mixer;
+    mixer.setMode(DRIVE_MODE_CURVATURE);
+    mixer.setExpo(0, 0);
+    int16_t slowLeft, slowRight, fastLeft, fastRight;
+
+    // Same steering, twice the throttle: the side difference (turn rate)
+    // grows with speed, so the turn radius stays roughly the same
+    mixer.mix(60, 128, slowLeft, slowRight);
+    mixer.mix(120, 128, fastLeft, fastRight);
+    int16_t slowTurn = slowLeft - slowRight;
+    int16_t fastTurn = fastLeft - fastRight;
+    CHECK(slowTurn > 0);
+    CHECK(fastTurn >= 2 * slowTurn - 2 && fastTurn <= 2 * slowTurn + 2);
+
+    // Below the quick-turn band it spins in place like arcade
+    int16_t left, right;
+    mixer.mix(0, 100, left, right);
+    CHECK_EQ(left, (100 * TURN_RATE_MULTIPLIER) >> 8);
+    CHECK_EQ(right, -left);
+}
+
+static void testCurvatureBlendIsContinuous() {
+    DriveMixer mixer;
+    mixer.setMode(DRIVE_MODE_CURVATURE);
+    mixer.setExpo(0, 0);
+    const int16_t bandEnd = DRIVE_QUICKTURN_THRESHOLD + DRIVE_QUICKTURN_BAND / 2;
+
+    // Full steering while the throttle sweeps through the quick-turn band:
+    // the turn rate falls steadily from a spin to the curvature rate. A hard
+    // switch at the threshold stepped it by ~370 counts in one.
+    int16_t left, right;
+    mixer.mix(0, 255, left, right);
+    int16_t previous = left - right;
+    for (int16_t throttle = 1; throttle <= bandEnd; throttle++) {
+        mixer.mix(throttle, 255, left, right);
+        int16_t turn = left - right;
+        CHECK(turn <= previous);
+        CHECK(previous - turn <= 32);
+        previous = turn;
+    }
+
+    // Past the band the turn rate follows the throttle again, smoothly
+    for (int16_t throttle = bandEnd + 1; throttle <= 2 * bandEnd; throttle++) {
+        mixer.mix(throttle, 255, left, right);
+        int16_t turn = left - right;
+        CHECK(turn >= previous);
+        CHECK(turn - previous <= 4);
+        previous = turn;
+    }
+
+    // Reverse mirrors forward
+    int16_t forwardLeft, forwardRight;
+    mixer.mix(DRIVE_QUICKTURN_THRESHOLD, 255, forwardLeft, forwardRight);
+    mixer.mix(-DRIVE_QUICKTURN_THRESHOLD, 255, left, right);
+    CHECK_EQ(left - right, forwardLeft - forwardRight);
+}
+
+static void testExpoCurve() {
+    DriveMixer mixer;
+
+    // 0% is linear
+    mixer.setExpo(0, 0);
+    for (int16_t x = -255; x <= 255; x++) {
+        CHECK_EQ(mixer.applySteeringCurve(x), x);
+    }
+
+    // 30% softens the middle, keeps the endpoints, stays monotonic and odd
+    mixer.setExpo(0, 30);
+    CHECK_EQ(mixer.applySteeringCurve(0), 0);
+    CHECK_EQ(mixer.applySteeringCurve(255), 255);
+    CHECK_EQ(mixer.applySteeringCurve(-255), -255);
+    CHECK(mixer.applySteeringCurve(128) < 128);
+    CHECK(mixer.applySteeringCurve(128) > 128 * 70 / 100);
+    int16_t previous = mixer.applySteeringCurve(0);
+    for (int16_t x = 1; x <= 255; x++) {
+        int16_t y = mixer.applySteeringCurve(x);
+        CHECK(y >= previous);
+        CHECK_EQ(mixer.applySteeringCurve(-x), -y);
+        previous = y;
+    }
+
+    // Throttle and steering curves are independent
+    CHECK_EQ(mixer.applyThrottleCurve(128), 128);
+}
+
+static void testInvalidSettingsRejected() {
+    DriveMixer mixer;
+    mixer.setMode(DRIVE_MODE_TANK);
+    mixer.setMode(7);
+    CHECK_EQ(mixer.getMode(), DRIVE_MODE_TANK);
+
+    // Out-of-range axes clamp rather than wrap
+    int16_t left, right;
+    mixer.mix(1000, -1000, left, right);
+    CHECK_EQ(left, 255);
+    CHECK_EQ(right, -255);
+
+    #ifndef TEST_SKV3
+    // Gains clamp at 4.0 so sums cannot overflow 16 bits
+    mixer.setMode(DRIVE_MODE_ARCADE);
+    mixer.setGains(0xFFFF, 0xFFFF);
+    mixer.mix(-255, 255, left, right);
+    CHECK(left >= -255 && left <= 255);
+    CHECK(right >= -255 && right <= 255);
+    #endif
+}
+
+static void testAxisDecode() {
+    // One offset-127 convention for every M command
+    CHECK_EQ(TEST_DECODE_AXIS(0), -255);
+    CHECK_EQ(TEST_DECODE_AXIS(DIFFERENTIAL_CENTER), 0);
+    CHECK_EQ(TEST_DECODE_AXIS(254), 255);
+    CHECK_EQ(TEST_DECODE_AXIS(255), 255);
+    CHECK_EQ(TEST_DECODE_AXIS(-5), -255);
+    CHECK_EQ(TEST_DECODE_AXIS(190), -TEST_DECODE_AXIS(64));
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main() {
+    printf("Target: %s\n", TEST_TARGET);
+
+    RUN_TEST(testDefaults);
+    RUN_TEST(testTankPassthrough);
+    #ifndef TEST_SKV3
+    RUN_TEST(testTankDifferentialGain);
+    #endif
+    RUN_TEST(testArcadeTurnRate);
+    RUN_TEST(testSaturationKeepsTurnRatio);
+    RUN_TEST(testCurvatureFollowsThrottle);
+    RUN_TEST(testCurvatureBlendIsContinuous);
+    RUN_TEST(testExpoCurve);
+    RUN_TEST(testInvalidSettingsRejected);
+    RUN_TEST(testAxisDecode);
+    return TEST_RESULT();
+}
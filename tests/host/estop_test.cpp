@@ -0,0 +1,310 @@
+/*
+ * Emergency Stop Test (host)
+ * Drives the sketch, pulls the e-stop pin low and checks that the ISR
+ * itself has every motor and weapon output at zero within
+ * EMERGENCY_RESPONSE_US - no waiting for loop() to notice. Then walks the
+ * re-arm sequence: refused while pressed, aborted by a re-press, and only
+ * complete after ESTOP_REARM_HOLD_MS released. Finally checks that an
+ * e-stop packet too far behind the sequence window still stops and is ACKed,
+ * and that a weapon packet is ACKed on both sketches. A held button must
+ * stop the robot even if its interrupt edge is lost.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -I tests/host/hal -I . tests/host/estop_test.cpp \
+ *       tests/host/hal/HostHal.cpp src/BluetoothComm.cpp src/SafetySystem.cpp \
+ *       src/WormMotorController.cpp src/TaskWatchdog.cpp \
+ *       src/DriveMixer.cpp src/LinkMonitor.cpp src/LinkLossPolicy.cpp \
+ *       src/BlackBox.cpp -o estop_test
+ *   ./estop_test
+ *
+ * Add -DTEST_SKV3 and build only this file plus HostHal.cpp to test
+ * SKV3_CombatRobot_Main.ino instead of sumo_robot_main.ino.
+ */
+
+#include "HostHal.h"
+#include "HostTest.h"
+#include "SoftwareSerial.h"
+
+// ============================================================================
+// FIRMWARE UNDER TEST
+// ============================================================================
+
+#include "SketchPrototypes.h"
+
+#ifdef TEST_SKV3
+#include "../../src/SKV3_CombatRobot_Main.ino"
+
+#define TEST_TARGET        "SKV3_CombatRobot_Main.ino"
+#define TEST_BT_RX_PIN     BT_RX_PIN
+#define TEST_ESTOP_PIN     EMERGENCY_STOP_PIN
+#define TEST_WEAPON_PIN    WEAPON_PIN
+#else
+#include "../../src/sumo_robot_main.ino"
+
+#define TEST_TARGET        "sumo_robot_main.ino"
+#define TEST_BT_RX_PIN     BT_SOFT_RX
+#define TEST_ESTOP_PIN     EMERGENCY_STOP_PIN
+#define TEST_WEAPON_PIN    WEAPON_PWM
+#endif
+
+#define TEST_BAUD          9600
+#define TEST_BATTERY_ADC   757      // 11.1V through the 3:1 divider
+
+static const uint8_t OUTPUT_PINS[] = { MOTOR_LEFT_PWM, MOTOR_LEFT_DIR1, MOTOR_LEFT_DIR2,
+                                       MOTOR_RIGHT_PWM, MOTOR_RIGHT_DIR1, MOTOR_RIGHT_DIR2,
+                                       TEST_WEAPON_PIN };
+
+static Stream* _port = nullptr;
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static void _runFor(unsigned long ms) {
+    uint64_t until = hostNowCycles() + hostMicrosToCycles(ms * 1000UL);
+    while (hostNowCycles() < until) {
+        loop();
+        hostAdvanceCycles(200);
+    }
+}
+
+static void _send(const char* command) {
+    _port->hostInject(command, strlen(command), TEST_BAUD, hostNowCycles());
+    _runFor(30);
+}
+
+// "!<length><seq><command><data><checksum>#", as the controller app sends
+static String _packet(int sequence, const char* body) {
+    String framed = "";
+    int length = 2 + 2 + strlen(body) + 2;
+    framed += (char)('0' + length / 10);
+    framed += (char)('0' + length % 10);
+    framed += (char)('0' + sequence / 10);
+    framed += (char)('0' + sequence % 10);
+    framed += body;
+
+    unsigned int sum = 0;
+    for (unsigned int i = 0; i < framed.length(); i++) sum += (uint8_t)framed.charAt(i);
+    framed += (char)('0' + sum % 100 / 10);
+    framed += (char)('0' + sum % 10);
+    return "!" + framed + "#";
+}
+
+static bool _outputsDead() {
+    for (uint8_t pin : OUTPUT_PINS) {
+        if (hostPinDuty(pin) != 0) return false;
+    }
+    return true;
+}
+
+static bool _motorsRunning() {
+    return hostPinDuty(MOTOR_LEFT_PWM) != 0 && hostPinDuty(MOTOR_RIGHT_PWM) != 0;
+}
+
+// Motors driving and weapon live, as in a match
+static void _driveWithWeapon() {
+    _send("F\n");
+    #ifdef TEST_SKV3
+    if (!weaponEnabled) _send("W\n");
+    #else
+    // The sumo sketch has no weapon command; drive the pin directly
+    pinMode(TEST_WEAPON_PIN, OUTPUT);
+    analogWrite(TEST_WEAPON_PIN, 200);
+    #endif
+}
+
+// Press the e-stop and return the cycles spent in the ISR
+static uint64_t _pressEstop() {
+    uint64_t before = hostNowCycles();
+    hostSetInput(TEST_ESTOP_PIN, LOW);
+    return hostNowCycles() - before;
+}
+
+static void _releaseEstop() {
+    hostSetInput(TEST_ESTOP_PIN, HIGH);
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+static void testIsrCutsOutputsWithinBudget() {
+    _driveWithWeapon();
+    CHECK(_motorsRunning());
+    CHECK(hostPinDuty(TEST_WEAPON_PIN) != 0);
+
+    uint64_t isrCycles = _pressEstop();
+
+    // Outputs are dead when the ISR returns, before loop() runs again
+    CHECK(_outputsDead());
+    CHECK(isrCycles <= hostMicrosToCycles(EMERGENCY_RESPONSE_US));
+    printf("  e-stop ISR: %llu cycles (%.2f us, budget %d us)\n",
+           (unsigned long long)isrCycles, hostCyclesToMicros(isrCycles), EMERGENCY_RESPONSE_US);
+
+    _runFor(50);
+    CHECK(_outputsDead());
+}
+
+static void testCommandsIgnoredWhileStopped() {
+    _send("F\n");
+    _send("A\n");
+    _send("M250250\n");
+    _runFor(100);
+    CHECK(_outputsDead());
+}
+
+static void testResetRefusedWhilePressed() {
+    _send("RESET\n");
+    _runFor(ESTOP_REARM_HOLD_MS * 2);
+    _send("F\n");
+    CHECK(_outputsDead());
+}
+
+static void testRepressAbortsRearm() {
+    _releaseEstop();
+    _runFor(20);
+    _send("RESET\n");
+
+    // Still stopped during the hold
+    _runFor(ESTOP_REARM_HOLD_MS / 2);
+    _send("F\n");
+    CHECK(_outputsDead());
+
+    // Bounce: pressed again before the hold completes
+    _pressEstop();
+    _runFor(10);
+    _releaseEstop();
+    _runFor(ESTOP_REARM_HOLD_MS * 2);
+    _send("F\n");
+    CHECK(_outputsDead());
+}
+
+static void testRearmAfterHold() {
+    _send("RESET\n");
+    _runFor(ESTOP_REARM_HOLD_MS + 50);
+
+    _send("F\n");
+    CHECK(_motorsRunning());
+}
+
+static void testSecondTripAfterRearm() {
+    _driveWithWeapon();
+    CHECK(_motorsRunning());
+
+    uint64_t isrCycles = _pressEstop();
+    CHECK(_outputsDead());
+    CHECK(isrCycles <= hostMicrosToCycles(EMERGENCY_RESPONSE_US));
+    _releaseEstop();
+}
+
+static void testStalePacketEstopActedOn() {
+    _send("RESET\n");
+    _runFor(ESTOP_REARM_HOLD_MS + 50);
+
+    // Sequenced drive packets up to 10...
+    for (int sequence = 0; sequence <= 10; sequence++) {
+        _send(_packet(sequence, "M254254").c_str());
+    }
+    CHECK(_motorsRunning());
+
+    // ...then the controller jumps to 60 with no silence in between: too
+    // old to tell for the sequence window, but an e-stop is never dropped
+    _port->hostClearTransmitted();
+    _send(_packet(60, "E").c_str());
+    CHECK(_outputsDead());
+    CHECK(_port->hostTransmitted().find("K60\n") != std::string::npos);
+}
+
+static void testWeaponPacketAcked() {
+    _send("RESET\n");
+    _runFor(ESTOP_REARM_HOLD_MS + 50);
+
+    // Critical on both sketches, so it must be ACKed or the app retries forever
+    _port->hostClearTransmitted();
+    _send(_packet(61, "W0").c_str());
+    CHECK(_port->hostTransmitted().find("K61\n") != std::string::npos);
+    CHECK(_port->hostTransmitted().find("ERROR") == std::string::npos);
+
+    // A corrupt packet is neither run nor ACKed, and reported once at most
+    String corrupted = _packet(62, "W0");
+    corrupted.setCharAt(4, '3');
+    _port->hostClearTransmitted();
+    _send(corrupted.c_str());
+    const std::string& reply = _port->hostTransmitted();
+    CHECK(reply.find("K6") == std::string::npos);
+    size_t firstError = reply.find("ERROR");
+    CHECK(firstError == std::string::npos || reply.find("ERROR", firstError + 1) == std::string::npos);
+}
+
+#ifdef TEST_SKV3
+static void testIsrDuringMotorPassKeepsOutputsDead() {
+    _send("RESET\n");
+    _runFor(ESTOP_REARM_HOLD_MS + 50);
+
+    // Decaying after a short dropout: every pass rewrites the motors
+    _send("F\n");
+    _runFor(LINK_HOLD_MS + 50);
+    CHECK(_motorsRunning());
+
+    // The ISR fires after loop() checked the flag; the rest of that pass,
+    // due a decay step by now, must not re-energise what it cut
+    _pressEstop();
+    hostAdvanceMicros(10000UL);
+    updateMotorSystems();
+    CHECK(_outputsDead());
+    _releaseEstop();
+}
+
+static void testHeldButtonTripsWithoutIsr() {
+    _send("RESET\n");
+    _runFor(ESTOP_REARM_HOLD_MS + 50);
+    _send("F\n");
+    CHECK(_motorsRunning());
+
+    // The edge is lost - as when a trip lands mid re-arm and is
+    // overwritten - but the button is held: the loop must still stop
+    uint8_t interrupt = digitalPinToInterrupt(TEST_ESTOP_PIN);
+    detachInterrupt(interrupt);
+    _pressEstop();
+    _runFor(20);
+    CHECK(_outputsDead());
+    _send("F\n");
+    CHECK(_outputsDead());
+
+    _releaseEstop();
+    attachInterrupt(interrupt, hardwareEmergencyISR, FALLING);
+}
+#endif
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main() {
+    #ifdef VOLTAGE_SENSE_PIN
+    hostSetAnalog(VOLTAGE_SENSE_PIN, TEST_BATTERY_ADC);
+    #endif
+    setup();
+
+    _port = hostSoftwareSerial(TEST_BT_RX_PIN);
+    if (!_port) {
+        printf("No SoftwareSerial on pin %d\n", TEST_BT_RX_PIN);
+        return 2;
+    }
+    printf("Target: %s\n", TEST_TARGET);
+
+    // Order matters: each test leaves the robot in the state the next expects
+    RUN_TEST(testIsrCutsOutputsWithinBudget);
+    RUN_TEST(testCommandsIgnoredWhileStopped);
+    RUN_TEST(testResetRefusedWhilePressed);
+    RUN_TEST(testRepressAbortsRearm);
+    RUN_TEST(testRearmAfterHold);
+    RUN_TEST(testSecondTripAfterRearm);
+    RUN_TEST(testStalePacketEstopActedOn);
+    RUN_TEST(testWeaponPacketAcked);
+    #ifdef TEST_SKV3
+    RUN_TEST(testIsrDuringMotorPassKeepsOutputsDead);
+    RUN_TEST(testHeldButtonTripsWithoutIsr);
+    #endif
+    return TEST_RESULT();
+}
@@ -0,0 +1,247 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*
+ * Host Arduino Core
+ * Minimal Arduino Uno API for running firmware on a PC against a
+ * virtual clock. See HostHal.h for the test-side controls.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <deque>
+#include <type_traits>
+#include "avr/io.h"
+
+#define F_CPU 16000000UL
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+
+#define NUM_DIGITAL_PINS 20
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+
+#define F(s) (s)
+
+// Return by value: with same-typed arguments the conditional is an lvalue
+// and a plain decltype would hand back a reference to a parameter
+template <typename A, typename B>
+inline auto min(A a, B b) -> typename std::decay<decltype(a < b ? a : b)>::type { return a < b ? a : b; }
+template <typename A, typename B>
+inline auto max(A a, B b) -> typename std::decay<decltype(a > b ? a : b)>::type { return a > b ? a : b; }
+template <typename T, typename L, typename H>
+inline T constrain(T x, L low, H high) { return x < low ? low : (x > high ? high : x); }
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+// Digital / analog I/O
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+int analogRead(uint8_t pin);
+
+// Time
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Interrupts
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(), int mode);
+void detachInterrupt(uint8_t interruptNum);
+void noInterrupts();
+void interrupts();
+#define cli() noInterrupts()
+#define sei() interrupts()
+
+// ============================================================================
+// String
+// ============================================================================
+
+class String {
+public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    explicit String(char c) : _s(1, c) {}
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(double value, unsigned char decimals = 2);
+
+    unsigned int length() const { return _s.length(); }
+    const char* c_str() const { return _s.c_str(); }
+    char charAt(unsigned int index) const { return index < _s.length() ? _s[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    void setCharAt(unsigned int index, char c) { if (index < _s.length()) _s[index] = c; }
+    void reserve(unsigned int size) { _s.reserve(size); }
+
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& s, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    bool startsWith(const String& s) const;
+    bool endsWith(const String& s) const;
+    bool equals(const String& s) const { return _s == s._s; }
+    bool equalsIgnoreCase(const String& s) const;
+
+    long toInt() const { return atol(_s.c_str()); }
+    float toFloat() const { return (float)atof(_s.c_str()); }
+    void trim();
+    void toUpperCase();
+    void toLowerCase();
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+
+    String& operator+=(const String& s) { _s += s._s; return *this; }
+    String& operator+=(const char* s) { _s += s; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    String& operator+=(int value) { return *this += String(value); }
+    String& operator+=(unsigned int value) { return *this += String(value); }
+    String& operator+=(long value) { return *this += String(value); }
+    String& operator+=(unsigned long value) { return *this += String(value); }
+    bool concat(const String& s) { _s += s._s; return true; }
+    bool concat(char c) { _s += c; return true; }
+
+    bool operator==(const String& s) const { return _s == s._s; }
+    bool operator==(const char* s) const { return _s == s; }
+    bool operator!=(const String& s) const { return _s != s._s; }
+    bool operator!=(const char* s) const { return _s != s; }
+
+private:
+    std::string _s;
+};
+
+String operator+(const String& a, const String& b);
+String operator+(const String& a, const char* b);
+String operator+(const char* a, const String& b);
+String operator+(const String& a, char b);
+String operator+(const String& a, int b);
+String operator+(const String& a, unsigned int b);
+String operator+(const String& a, long b);
+String operator+(const String& a, unsigned long b);
+String operator+(const String& a, double b);
+
+// ============================================================================
+// Print / Stream
+// ============================================================================
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    virtual int availableForWrite() { return 0; }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print(String((unsigned int)value, base)); }
+    size_t print(int value, int base = DEC) { return print(String(value, base)); }
+    size_t print(unsigned int value, int base = DEC) { return print(String(value, base)); }
+    size_t print(long value, int base = DEC) { return print(String(value, base)); }
+    size_t print(unsigned long value, int base = DEC) { return print(String(value, base)); }
+    size_t print(double value, int decimals = 2) { return print(String(value, decimals)); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(T value) { return print(value) + println(); }
+    template <typename T>
+    size_t println(T value, int format) { return print(value, format) + println(); }
+};
+
+/*
+ * Stream with a timed receive queue. Bytes injected by the host only
+ * become readable once their stop bit has arrived on the virtual clock,
+ * and are dropped if the 64-byte receive buffer is full at that time.
+ */
+class Stream : public Print {
+public:
+    static const size_t RX_BUFFER_SIZE = 64;
+
+    Stream();
+    virtual ~Stream() {}
+
+    virtual int available();
+    virtual int read();
+    virtual int peek();
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    String readString();
+    String readStringUntil(char terminator);
+
+    // Host side: queue bytes at the given baud starting at startCycles.
+    // Returns the cycle at which the last stop bit arrives.
+    uint64_t hostInject(const char* data, size_t size, unsigned long baud, uint64_t startCycles);
+    uint64_t hostNextArrival() const;
+    size_t hostPending() const;
+    size_t hostDropped() const { return _dropped; }
+    void hostClear();
+
+    // Host side: the most recent bytes the firmware wrote to this port
+    const std::string& hostTransmitted() const { return _transmitted; }
+    void hostClearTransmitted() { _transmitted.clear(); }
+
+protected:
+    unsigned long _timeout;
+    void _hostRecordTx(uint8_t b);
+
+private:
+    struct TimedByte { uint64_t atCycles; uint8_t value; };
+    std::deque<TimedByte> _pending;
+    std::string _buffer;
+    std::string _transmitted;
+    size_t _dropped;
+
+    void _receiveArrived();
+    int _timedRead();
+};
+
+class HardwareSerial : public Stream {
+public:
+    HardwareSerial() : _txBusyUntil(0), _byteCycles(0) {}
+    void begin(unsigned long baud);
+    void end() {}
+    void flush();
+    size_t write(uint8_t b) override;
+    int availableForWrite() override;       // Free space in the TX ring
+    using Print::write;
+    operator bool() const { return true; }
+
+private:
+    static const uint64_t TX_BUFFER_SIZE = 64;
+    uint64_t _txBusyUntil;
+    uint64_t _byteCycles;
+};
+
+extern HardwareSerial Serial;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,816 @@
+#include "HostHal.h"
+#include "SoftwareSerial.h"
+#include "avr/eeprom.h"
+#include <stdio.h>
+#include <ctype.h>
+#include <vector>
+#include <algorithm>
+
+/*
+ * Host HAL Implementation
+ * Arduino core emulation for an ATmega328P running at 16 MHz
+ */
+
+// ============================================================================
+// REGISTERS AND STATE
+// ============================================================================
+
+HostReg<uint8_t> PORTB, PORTC, PORTD;
+HostReg<uint8_t> DDRB, DDRC, DDRD;
+HostReg<uint8_t> PINB, PINC, PIND;
+HostReg<uint8_t> TCCR0A, TCCR0B, OCR0A, OCR0B;
+HostReg<uint8_t> TCCR1A, TCCR1B;
+HostReg<uint16_t> OCR1A, OCR1B;
+HostReg<uint8_t> TCCR2A, TCCR2B, OCR2A, OCR2B;
+HostReg<uint8_t> SREG(_BV(SREG_I));  // init() enables interrupts before setup()
+HostReg<uint8_t> WDTCSR, MCUSR(_BV(PORF));
+
+HardwareSerial Serial;
+
+static uint64_t _cycles = 0;
+static bool _inputDriven[NUM_DIGITAL_PINS];
+static uint8_t _inputLevel[NUM_DIGITAL_PINS];
+static int _analogValue[NUM_DIGITAL_PINS];
+
+static void (*_isr[2])() = { nullptr, nullptr };
+static int _isrMode[2] = { 0, 0 };
+static bool _isrPending[2] = { false, false };
+
+static bool _wdtInterruptPending = false;
+static bool _wdtInReset = false;
+static bool _wdtBusy = false;
+static uint64_t _wdtLastReset = 0;
+static unsigned long _wdtResets = 0;
+
+// Implemented by firmware with ISR(WDT_vect)
+extern "C" void host_WDT_vect(void) __attribute__((weak));
+
+static uint32_t _probeMask = 0;
+static uint64_t _probeAfter = 0;
+static bool _probeFired = false;
+static uint64_t _probeCycles = 0;
+
+// Function-local so firmware globals can register from their constructors
+static std::vector<SoftwareSerial*>& _softSerials() {
+    static std::vector<SoftwareSerial*> ports;
+    return ports;
+}
+
+// ============================================================================
+// VIRTUAL CLOCK
+// ============================================================================
+
+static void _wdtTimeout();
+
+static uint64_t _wdtPeriodCycles() {
+    // 128 kHz oscillator: 2K cycles (16 ms) doubled per prescaler step
+    uint8_t control = WDTCSR.raw();
+    uint8_t prescaler = (control & 0x07) | ((control & _BV(WDP3)) ? 0x08 : 0);
+    if (prescaler > 9) prescaler = 9;
+    return (uint64_t)(F_CPU / 1000UL) * 16ULL << prescaler;
+}
+
+static bool _wdtRunning() {
+    return !_wdtInReset && (WDTCSR.raw() & (_BV(WDE) | _BV(WDIE)));
+}
+
+// Every clock movement goes through here so the watchdog fires at the
+// right virtual time, even in the middle of a long delay()
+static void _advanceTo(uint64_t target) {
+    while (!_wdtBusy && _wdtRunning() && _wdtLastReset + _wdtPeriodCycles() <= target) {
+        uint64_t timeout = _wdtLastReset + _wdtPeriodCycles();
+        if (timeout > _cycles) _cycles = timeout;
+        _wdtLastReset = timeout;
+        _wdtTimeout();
+    }
+    if (target > _cycles) _cycles = target;
+}
+
+void hostChargeCycles(uint32_t cycles) {
+    _advanceTo(_cycles + cycles);
+}
+
+uint64_t hostNowCycles() {
+    return _cycles;
+}
+
+void hostAdvanceCycles(uint64_t cycles) {
+    _advanceTo(_cycles + cycles);
+}
+
+void hostAdvanceMicros(unsigned long us) {
+    hostAdvanceCycles(hostMicrosToCycles(us));
+}
+
+unsigned long millis() {
+    return (unsigned long)(_cycles / (F_CPU / 1000UL));
+}
+
+unsigned long micros() {
+    return (unsigned long)(_cycles / HOST_CYCLES_PER_US);
+}
+
+void delay(unsigned long ms) {
+    hostAdvanceCycles((uint64_t)ms * (F_CPU / 1000UL));
+}
+
+void delayMicroseconds(unsigned int us) {
+    hostAdvanceMicros(us);
+}
+
+// ============================================================================
+// PIN MODEL
+// ============================================================================
+
+static HostReg<uint8_t>* _portReg(uint8_t pin) {
+    if (pin < 8) return &PORTD;
+    if (pin < 14) return &PORTB;
+    return &PORTC;
+}
+
+static HostReg<uint8_t>* _ddrReg(uint8_t pin) {
+    if (pin < 8) return &DDRD;
+    if (pin < 14) return &DDRB;
+    return &DDRC;
+}
+
+static uint8_t _pinBit(uint8_t pin) {
+    if (pin < 8) return _BV(pin);
+    if (pin < 14) return _BV(pin - 8);
+    return _BV(pin - 14);
+}
+
+// Timer output-compare channel driving a pin: control register + COM bit
+static HostReg<uint8_t>* _pwmControl(uint8_t pin, uint8_t& comBit) {
+    switch (pin) {
+        case 3:  comBit = COM2B1; return &TCCR2A;
+        case 5:  comBit = COM0B1; return &TCCR0A;
+        case 6:  comBit = COM0A1; return &TCCR0A;
+        case 9:  comBit = COM1A1; return &TCCR1A;
+        case 10: comBit = COM1B1; return &TCCR1A;
+        case 11: comBit = COM2A1; return &TCCR2A;
+        default: return nullptr;
+    }
+}
+
+static uint8_t _pwmCompare(uint8_t pin) {
+    switch (pin) {
+        case 3:  return OCR2B.raw();
+        case 5:  return OCR0B.raw();
+        case 6:  return OCR0A.raw();
+        case 9:  return (uint8_t)OCR1A.raw();
+        case 10: return (uint8_t)OCR1B.raw();
+        case 11: return OCR2A.raw();
+        default: return 0;
+    }
+}
+
+static void _setPwmCompare(uint8_t pin, uint8_t value) {
+    switch (pin) {
+        case 3:  OCR2B.setRaw(value); break;
+        case 5:  OCR0B.setRaw(value); break;
+        case 6:  OCR0A.setRaw(value); break;
+        case 9:  OCR1A.setRaw(value); break;
+        case 10: OCR1B.setRaw(value); break;
+        case 11: OCR2A.setRaw(value); break;
+    }
+}
+
+static bool _pwmActive(uint8_t pin) {
+    uint8_t comBit = 0;
+    HostReg<uint8_t>* control = _pwmControl(pin, comBit);
+    return control && (control->raw() & _BV(comBit));
+}
+
+static void _turnOffPWM(uint8_t pin) {
+    uint8_t comBit = 0;
+    HostReg<uint8_t>* control = _pwmControl(pin, comBit);
+    if (control) control->setRaw(control->raw() & ~_BV(comBit));
+}
+
+static void _setPortBit(uint8_t pin, bool high) {
+    HostReg<uint8_t>* port = _portReg(pin);
+    uint8_t bit = _pinBit(pin);
+    port->setRaw(high ? (port->raw() | bit) : (port->raw() & ~bit));
+}
+
+static int _pinLevel(uint8_t pin) {
+    if (_ddrReg(pin)->raw() & _pinBit(pin)) {
+        return (_portReg(pin)->raw() & _pinBit(pin)) ? HIGH : LOW;
+    }
+    if (_inputDriven[pin]) return _inputLevel[pin];
+    // Floating input reads the pull-up when enabled
+    return (_portReg(pin)->raw() & _pinBit(pin)) ? HIGH : LOW;
+}
+
+static void _recordWrite(uint8_t pin, uint8_t dutyBefore) {
+    if (_probeFired || !(_probeMask & (1UL << pin))) return;
+    if (_cycles < _probeAfter || hostPinDuty(pin) == dutyBefore) return;
+    _probeFired = true;
+    _probeCycles = _cycles;
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= NUM_DIGITAL_PINS) return;
+    hostChargeCycles(HOST_COST_PIN_MODE);
+    HostReg<uint8_t>* ddr = _ddrReg(pin);
+    uint8_t bit = _pinBit(pin);
+    if (mode == OUTPUT) {
+        ddr->setRaw(ddr->raw() | bit);
+    } else {
+        ddr->setRaw(ddr->raw() & ~bit);
+        _setPortBit(pin, mode == INPUT_PULLUP);
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin >= NUM_DIGITAL_PINS) return;
+    hostChargeCycles(HOST_COST_DIGITAL_WRITE);
+    uint8_t dutyBefore = hostPinDuty(pin);
+    _turnOffPWM(pin);
+    _setPortBit(pin, value != LOW);
+    _recordWrite(pin, dutyBefore);
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= NUM_DIGITAL_PINS) return LOW;
+    hostChargeCycles(HOST_COST_DIGITAL_READ);
+    _turnOffPWM(pin);
+    return _pinLevel(pin);
+}
+
+void analogWrite(uint8_t pin, int value) {
+    if (pin >= NUM_DIGITAL_PINS) return;
+    hostChargeCycles(HOST_COST_ANALOG_WRITE);
+    uint8_t dutyBefore = hostPinDuty(pin);
+    HostReg<uint8_t>* ddr = _ddrReg(pin);
+    ddr->setRaw(ddr->raw() | _pinBit(pin));
+
+    uint8_t comBit = 0;
+    HostReg<uint8_t>* control = _pwmControl(pin, comBit);
+    if (value <= 0 || value >= 255 || !control) {
+        _turnOffPWM(pin);
+        _setPortBit(pin, control ? value >= 255 : value >= 128);
+    } else {
+        control->setRaw(control->raw() | _BV(comBit));
+        _setPwmCompare(pin, (uint8_t)value);
+    }
+    _recordWrite(pin, dutyBefore);
+}
+
+int analogRead(uint8_t pin) {
+    if (pin < A0) pin += A0;
+    if (pin >= NUM_DIGITAL_PINS) return 0;
+    hostChargeCycles(HOST_COST_ANALOG_READ);
+    return _analogValue[pin];
+}
+
+uint8_t hostPinDuty(uint8_t pin) {
+    if (pin >= NUM_DIGITAL_PINS || !hostPinIsOutput(pin)) return 0;
+    if (_pwmActive(pin)) return _pwmCompare(pin);
+    return (_portReg(pin)->raw() & _pinBit(pin)) ? 255 : 0;
+}
+
+bool hostPinIsOutput(uint8_t pin) {
+    return pin < NUM_DIGITAL_PINS && (_ddrReg(pin)->raw() & _pinBit(pin));
+}
+
+void hostSetAnalog(uint8_t pin, int value) {
+    if (pin < A0) pin += A0;
+    if (pin < NUM_DIGITAL_PINS) _analogValue[pin] = constrain(value, 0, 1023);
+}
+
+// ============================================================================
+// INTERRUPTS
+// ============================================================================
+
+static bool _interruptsEnabled() {
+    return SREG.raw() & _BV(SREG_I);
+}
+
+static void _runISR(uint8_t interruptNum) {
+    hostChargeCycles(HOST_COST_ISR_ENTRY);
+    SREG.setRaw(SREG.raw() & ~_BV(SREG_I));
+    _isr[interruptNum]();
+    SREG.setRaw(SREG.raw() | _BV(SREG_I));
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(), int mode) {
+    if (interruptNum > 1) return;
+    _isr[interruptNum] = userFunc;
+    _isrMode[interruptNum] = mode;
+    _isrPending[interruptNum] = false;
+}
+
+void detachInterrupt(uint8_t interruptNum) {
+    if (interruptNum > 1) return;
+    _isr[interruptNum] = nullptr;
+}
+
+void noInterrupts() {
+    SREG.setRaw(SREG.raw() & ~_BV(SREG_I));
+}
+
+static void _runWatchdogISR() {
+    _wdtInterruptPending = false;
+    if (!host_WDT_vect) return;
+    _wdtBusy = true;
+    hostChargeCycles(HOST_COST_ISR_ENTRY);
+    SREG.setRaw(SREG.raw() & ~_BV(SREG_I));
+    host_WDT_vect();
+    SREG.setRaw(SREG.raw() | _BV(SREG_I));
+    _wdtBusy = false;
+}
+
+void interrupts() {
+    SREG.setRaw(SREG.raw() | _BV(SREG_I));
+    if (_wdtInterruptPending) _runWatchdogISR();
+    for (uint8_t i = 0; i < 2; i++) {
+        if (_isrPending[i] && _isr[i]) {
+            _isrPending[i] = false;
+            _runISR(i);
+        }
+    }
+}
+
+void hostTriggerInterrupt(uint8_t interruptNum) {
+    if (interruptNum > 1 || !_isr[interruptNum]) return;
+    if (_interruptsEnabled()) {
+        _runISR(interruptNum);
+    } else {
+        _isrPending[interruptNum] = true;
+    }
+}
+
+void hostSetInput(uint8_t pin, int level) {
+    if (pin >= NUM_DIGITAL_PINS) return;
+    int before = _pinLevel(pin);
+    _inputDriven[pin] = true;
+    _inputLevel[pin] = level ? HIGH : LOW;
+    int after = _pinLevel(pin);
+
+    int interruptNum = digitalPinToInterrupt(pin);
+    if (interruptNum == NOT_AN_INTERRUPT || before == after) return;
+    int mode = _isrMode[interruptNum];
+    if (mode == CHANGE || (mode == FALLING && after == LOW) || (mode == RISING && after == HIGH)) {
+        hostTriggerInterrupt(interruptNum);
+    }
+}
+
+// ============================================================================
+// WATCHDOG
+// ============================================================================
+
+static void _clearIO() {
+    HostReg<uint8_t>* regs8[] = { &PORTB, &PORTC, &PORTD, &DDRB, &DDRC, &DDRD,
+                                  &PINB, &PINC, &PIND, &TCCR0A, &TCCR0B, &OCR0A, &OCR0B,
+                                  &TCCR1A, &TCCR1B, &TCCR2A, &TCCR2B, &OCR2A, &OCR2B };
+    for (HostReg<uint8_t>* reg : regs8) reg->setRaw(0);
+    OCR1A.setRaw(0);
+    OCR1B.setRaw(0);
+}
+
+static void _wdtTimeout() {
+    uint8_t control = WDTCSR.raw();
+
+    if (control & _BV(WDIE)) {
+        // Interrupt (and reset) mode: the vector runs first and hardware
+        // clears WDIE, so the next timeout resets unless WDIE is re-armed
+        if (control & _BV(WDE)) WDTCSR.setRaw(control & ~_BV(WDIE));
+        if (_interruptsEnabled()) {
+            _runWatchdogISR();
+        } else {
+            _wdtInterruptPending = true;
+        }
+        return;
+    }
+
+    if (control & _BV(WDE)) {
+        // System reset: every pin tri-states, so the drivers see no signal.
+        // The host keeps running code, but the chip stays held in reset
+        // until the test calls hostWatchdogReboot().
+        MCUSR.setRaw(MCUSR.raw() | _BV(WDRF));
+        _clearIO();
+        _wdtResets++;
+        _wdtInReset = true;
+        _wdtInterruptPending = false;
+    }
+}
+
+void hostWdtReset() {
+    hostChargeCycles(1);
+    _wdtLastReset = _cycles;
+}
+
+unsigned long hostWatchdogResets() {
+    return _wdtResets;
+}
+
+bool hostWatchdogInReset() {
+    return _wdtInReset;
+}
+
+void hostWatchdogReboot() {
+    // Optiboot turns the watchdog off before jumping to the sketch;
+    // MCUSR and .noinit RAM survive
+    _clearIO();
+    WDTCSR.setRaw(0);
+    SREG.setRaw(_BV(SREG_I));
+    _wdtInReset = false;
+    _wdtInterruptPending = false;
+    _wdtLastReset = _cycles;
+    for (uint8_t i = 0; i < 2; i++) {
+        _isr[i] = nullptr;
+        _isrPending[i] = false;
+    }
+}
+
+// ============================================================================
+// EEPROM
+// ============================================================================
+
+static uint8_t _eeprom[HOST_EEPROM_SIZE];
+static unsigned long _eepromWrites[HOST_EEPROM_SIZE];
+static uint64_t _eepromBusyUntil = 0;
+static bool _eepromErased = false;
+
+static void _eepromWait() {
+    if (!_eepromErased) hostEepromErase();
+    if (_eepromBusyUntil > _cycles) _advanceTo(_eepromBusyUntil);
+}
+
+bool hostEepromReady() {
+    hostChargeCycles(2);
+    return _eepromBusyUntil <= _cycles;
+}
+
+uint8_t hostEepromRead(uint16_t address) {
+    _eepromWait();
+    hostChargeCycles(8);
+    return _eeprom[address % HOST_EEPROM_SIZE];
+}
+
+void hostEepromWrite(uint16_t address, uint8_t value) {
+    _eepromWait();
+    hostChargeCycles(12);
+    address %= HOST_EEPROM_SIZE;
+    _eeprom[address] = value;
+    _eepromWrites[address]++;
+    _eepromBusyUntil = _cycles + hostMicrosToCycles(HOST_EEPROM_WRITE_US);
+}
+
+void hostEepromErase() {
+    memset(_eeprom, 0xFF, sizeof(_eeprom));
+    memset(_eepromWrites, 0, sizeof(_eepromWrites));
+    _eepromBusyUntil = 0;
+    _eepromErased = true;
+}
+
+unsigned long hostEepromWrites(uint16_t address) {
+    return _eepromWrites[address % HOST_EEPROM_SIZE];
+}
+
+unsigned long hostEepromTotalWrites() {
+    unsigned long total = 0;
+    for (uint16_t i = 0; i < HOST_EEPROM_SIZE; i++) total += _eepromWrites[i];
+    return total;
+}
+
+// ============================================================================
+// WRITE PROBE
+// ============================================================================
+
+void hostArmWriteProbe(uint32_t pinMask, uint64_t afterCycles) {
+    _probeMask = pinMask;
+    _probeAfter = afterCycles;
+    _probeFired = false;
+    _probeCycles = 0;
+}
+
+bool hostProbeFired() {
+    return _probeFired;
+}
+
+uint64_t hostProbeCycles() {
+    return _probeCycles;
+}
+
+// ============================================================================
+// RESET
+// ============================================================================
+
+void hostReset() {
+    _clearIO();
+    SREG.setRaw(_BV(SREG_I));
+    WDTCSR.setRaw(0);
+    MCUSR.setRaw(_BV(PORF));
+
+    _cycles = 0;
+    _eepromBusyUntil = 0;
+    _wdtLastReset = 0;
+    _wdtResets = 0;
+    _wdtInReset = false;
+    _wdtInterruptPending = false;
+    for (uint8_t pin = 0; pin < NUM_DIGITAL_PINS; pin++) {
+        _inputDriven[pin] = false;
+        _inputLevel[pin] = LOW;
+        _analogValue[pin] = 0;
+    }
+    for (uint8_t i = 0; i < 2; i++) {
+        _isr[i] = nullptr;
+        _isrMode[i] = 0;
+        _isrPending[i] = false;
+    }
+    hostArmWriteProbe(0, 0);
+
+    Serial.hostClear();
+    for (SoftwareSerial* port : _softSerials()) port->hostClear();
+}
+
+// ============================================================================
+// STRING
+// ============================================================================
+
+static std::string _formatInteger(unsigned long value, unsigned char base, bool negative) {
+    if (base < 2) base = 10;
+    char buffer[72];
+    int pos = sizeof(buffer) - 1;
+    buffer[pos] = 0;
+    do {
+        int digit = value % base;
+        buffer[--pos] = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        value /= base;
+    } while (value);
+    if (negative) buffer[--pos] = '-';
+    return std::string(&buffer[pos]);
+}
+
+String::String(int value, unsigned char base)
+    : _s(base == 10 ? _formatInteger(value < 0 ? -(long)value : value, base, value < 0)
+                    : _formatInteger((unsigned int)value, base, false)) {}
+
+String::String(unsigned int value, unsigned char base) : _s(_formatInteger(value, base, false)) {}
+
+String::String(long value, unsigned char base)
+    : _s(base == 10 ? _formatInteger(value < 0 ? -value : value, base, value < 0)
+                    : _formatInteger((unsigned long)value, base, false)) {}
+
+String::String(unsigned long value, unsigned char base) : _s(_formatInteger(value, base, false)) {}
+
+String::String(double value, unsigned char decimals) {
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    _s = buffer;
+}
+
+String String::substring(unsigned int from) const {
+    return substring(from, length());
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= length()) return String();
+    if (to > length()) to = length();
+    return String(_s.substr(from, to - from));
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t pos = _s.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& s, unsigned int from) const {
+    size_t pos = _s.find(s._s, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t pos = _s.rfind(c);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+bool String::startsWith(const String& s) const {
+    return _s.compare(0, s._s.length(), s._s) == 0;
+}
+
+bool String::endsWith(const String& s) const {
+    return _s.length() >= s._s.length() &&
+           _s.compare(_s.length() - s._s.length(), s._s.length(), s._s) == 0;
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+    if (length() != s.length()) return false;
+    for (unsigned int i = 0; i < length(); i++) {
+        if (tolower((unsigned char)_s[i]) != tolower((unsigned char)s._s[i])) return false;
+    }
+    return true;
+}
+
+void String::trim() {
+    size_t begin = 0;
+    while (begin < _s.length() && isspace((unsigned char)_s[begin])) begin++;
+    size_t end = _s.length();
+    while (end > begin && isspace((unsigned char)_s[end - 1])) end--;
+    _s = _s.substr(begin, end - begin);
+}
+
+void String::toUpperCase() {
+    for (char& c : _s) c = toupper((unsigned char)c);
+}
+
+void String::toLowerCase() {
+    for (char& c : _s) c = tolower((unsigned char)c);
+}
+
+void String::remove(unsigned int index) {
+    if (index < length()) _s.erase(index);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < length()) _s.erase(index, count);
+}
+
+String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+String operator+(const String& a, char b) { String r(a); r += b; return r; }
+String operator+(const String& a, int b) { return a + String(b); }
+String operator+(const String& a, unsigned int b) { return a + String(b); }
+String operator+(const String& a, long b) { return a + String(b); }
+String operator+(const String& a, unsigned long b) { return a + String(b); }
+String operator+(const String& a, double b) { return a + String(b); }
+
+// ============================================================================
+// PRINT / STREAM
+// ============================================================================
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size--) written += write(*buffer++);
+    return written;
+}
+
+Stream::Stream() : _timeout(1000), _dropped(0) {}
+
+void Stream::_receiveArrived() {
+    while (!_pending.empty() && _pending.front().atCycles <= _cycles) {
+        if (_buffer.size() < RX_BUFFER_SIZE) {
+            _buffer += (char)_pending.front().value;
+        } else {
+            _dropped++;
+        }
+        _pending.pop_front();
+    }
+}
+
+int Stream::available() {
+    _receiveArrived();
+    return (int)_buffer.size();
+}
+
+int Stream::read() {
+    _receiveArrived();
+    if (_buffer.empty()) return -1;
+    uint8_t c = (uint8_t)_buffer[0];
+    _buffer.erase(0, 1);
+    return c;
+}
+
+int Stream::peek() {
+    _receiveArrived();
+    return _buffer.empty() ? -1 : (uint8_t)_buffer[0];
+}
+
+int Stream::_timedRead() {
+    // Mirrors Stream::timedRead(): poll until a byte arrives or _timeout
+    // milliseconds pass on millis()
+    unsigned long startMillis = millis();
+    uint64_t deadline = (uint64_t)(startMillis + _timeout) * (F_CPU / 1000UL);
+    for (;;) {
+        int c = read();
+        if (c >= 0) return c;
+        if (_pending.empty() || _pending.front().atCycles >= deadline) {
+            _advanceTo(deadline);
+            return -1;
+        }
+        _advanceTo(_pending.front().atCycles);
+    }
+}
+
+String Stream::readString() {
+    String result;
+    int c = _timedRead();
+    while (c >= 0) {
+        result += (char)c;
+        c = _timedRead();
+    }
+    return result;
+}
+
+String Stream::readStringUntil(char terminator) {
+    String result;
+    int c = _timedRead();
+    while (c >= 0 && c != terminator) {
+        result += (char)c;
+        c = _timedRead();
+    }
+    return result;
+}
+
+uint64_t Stream::hostInject(const char* data, size_t size, unsigned long baud, uint64_t startCycles) {
+    // 8N1 framing: start + 8 data + stop bits per byte
+    uint64_t byteCycles = (10ULL * F_CPU + baud / 2) / baud;
+    uint64_t at = startCycles;
+    if (!_pending.empty() && _pending.back().atCycles > at) at = _pending.back().atCycles;
+    for (size_t i = 0; i < size; i++) {
+        at += byteCycles;
+        TimedByte byte = { at, (uint8_t)data[i] };
+        _pending.push_back(byte);
+    }
+    return at;
+}
+
+uint64_t Stream::hostNextArrival() const {
+    return _pending.empty() ? UINT64_MAX : _pending.front().atCycles;
+}
+
+size_t Stream::hostPending() const {
+    return _pending.size() + _buffer.size();
+}
+
+void Stream::hostClear() {
+    _pending.clear();
+    _buffer.clear();
+    _transmitted.clear();
+    _dropped = 0;
+    _timeout = 1000;
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+    _byteCycles = (10ULL * F_CPU + baud / 2) / baud;
+    _txBusyUntil = _cycles;
+}
+
+void Stream::_hostRecordTx(uint8_t b) {
+    // Bounded so long benchmark runs do not grow without limit
+    if (_transmitted.size() >= 4096) _transmitted.erase(0, 2048);
+    _transmitted += (char)b;
+}
+
+size_t HardwareSerial::write(uint8_t b) {
+    _hostRecordTx(b);
+    if (_byteCycles == 0) return 1;
+    // Interrupt-driven TX: the caller only blocks once the 64-byte ring is full
+    uint64_t busy = _txBusyUntil > _cycles ? _txBusyUntil : _cycles;
+    uint64_t limit = (TX_BUFFER_SIZE - 1) * _byteCycles;
+    if (busy - _cycles > limit) _advanceTo(busy - limit);
+    _txBusyUntil = busy + _byteCycles;
+    return 1;
+}
+
+int HardwareSerial::availableForWrite() {
+    if (_byteCycles == 0) return (int)(TX_BUFFER_SIZE - 1);
+    uint64_t queued = _txBusyUntil > _cycles ? (_txBusyUntil - _cycles + _byteCycles - 1) / _byteCycles : 0;
+    return queued >= TX_BUFFER_SIZE - 1 ? 0 : (int)(TX_BUFFER_SIZE - 1 - queued);
+}
+
+void HardwareSerial::flush() {
+    _advanceTo(_txBusyUntil);
+}
+
+// ============================================================================
+// SOFTWARE SERIAL
+// ============================================================================
+
+SoftwareSerial::SoftwareSerial(uint8_t rxPin, uint8_t txPin, bool inverseLogic)
+    : _rxPin(rxPin), _txPin(txPin), _byteCycles(0) {
+    (void)inverseLogic;
+    _softSerials().push_back(this);
+}
+
+SoftwareSerial::~SoftwareSerial() {
+    std::vector<SoftwareSerial*>& ports = _softSerials();
+    ports.erase(std::remove(ports.begin(), ports.end(), this), ports.end());
+}
+
+void SoftwareSerial::begin(long baud) {
+    _byteCycles = (10ULL * F_CPU + baud / 2) / baud;
+}
+
+size_t SoftwareSerial::write(uint8_t b) {
+    _hostRecordTx(b);
+    // Bit-banged with interrupts off: the CPU is busy for the whole frame
+    hostAdvanceCycles(_byteCycles);
+    return 1;
+}
+
+SoftwareSerial* hostSoftwareSerial(uint8_t rxPin) {
+    for (SoftwareSerial* port : _softSerials()) {
+        if (port->rxPin() == rxPin) return port;
+    }
+    return nullptr;
+}
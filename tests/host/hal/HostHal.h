@@ -0,0 +1,78 @@
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+/*
+ * Host HAL Controls
+ * Test-side access to the virtual clock, pin states and UARTs of the
+ * host Arduino core. Firmware code never includes this header.
+ *
+ * Timing model (ATmega328P @ 16 MHz):
+ *   - the clock only moves when the firmware spends time: delay(),
+ *     blocking serial reads/writes, core I/O calls and register access
+ *   - digitalWrite/analogWrite/digitalRead/pinMode and analogRead carry
+ *     their measured Uno core costs, register access costs 1-2 cycles
+ *   - UART bytes arrive 10 bit times apart at the injected baud rate
+ *   - the watchdog runs off the same clock (16 ms << WDP prescaler)
+ */
+
+#include "Arduino.h"
+
+class SoftwareSerial;
+
+#define HOST_CYCLES_PER_US (F_CPU / 1000000UL)
+
+// Core I/O costs in CPU cycles (Arduino AVR core, measured on Uno)
+#define HOST_COST_DIGITAL_WRITE  60
+#define HOST_COST_DIGITAL_READ   50
+#define HOST_COST_ANALOG_WRITE   100
+#define HOST_COST_PIN_MODE       50
+#define HOST_COST_ANALOG_READ    1700
+#define HOST_COST_ISR_ENTRY      40
+
+// Reset all pins, registers, interrupts, UARTs and the clock
+void hostReset();
+
+// Virtual clock
+uint64_t hostNowCycles();
+void hostAdvanceCycles(uint64_t cycles);
+void hostAdvanceMicros(unsigned long us);
+inline uint64_t hostMicrosToCycles(unsigned long us) { return (uint64_t)us * HOST_CYCLES_PER_US; }
+inline double hostCyclesToMicros(uint64_t cycles) { return (double)cycles / HOST_CYCLES_PER_US; }
+
+// Pin state as seen on the header: PWM duty 0-255 (255 = driven HIGH)
+uint8_t hostPinDuty(uint8_t pin);
+bool hostPinIsOutput(uint8_t pin);
+
+// External stimulus
+void hostSetInput(uint8_t pin, int level);      // fires attached interrupts on edges
+void hostSetAnalog(uint8_t pin, int value);     // 0-1023
+void hostTriggerInterrupt(uint8_t interruptNum);
+
+// Write probe: records the first digitalWrite/analogWrite at or after
+// afterCycles that changes the output of a pin in pinMask (rewriting the
+// same value, e.g. a periodic stop(), does not count)
+void hostArmWriteProbe(uint32_t pinMask, uint64_t afterCycles);
+bool hostProbeFired();
+uint64_t hostProbeCycles();
+
+// Watchdog: the WDT counts on the virtual clock and runs ISR(WDT_vect)
+// and/or resets the chip exactly like the hardware. A reset tri-states
+// all pins and holds the chip until hostWatchdogReboot(), which keeps
+// MCUSR and .noinit RAM so the next setup() can read them.
+unsigned long hostWatchdogResets();
+bool hostWatchdogInReset();
+void hostWatchdogReboot();
+
+// EEPROM: 1 KB, erased (0xFF) at start-up and kept across hostReset() and
+// watchdog resets. A byte write takes 3.4 ms; every cell counts its writes
+// so tests can check wear.
+#define HOST_EEPROM_SIZE         1024
+#define HOST_EEPROM_WRITE_US     3400
+void hostEepromErase();
+unsigned long hostEepromWrites(uint16_t address);
+unsigned long hostEepromTotalWrites();
+
+// UART lookup (hardware Serial is on pin 0)
+SoftwareSerial* hostSoftwareSerial(uint8_t rxPin);
+
+#endif // HOST_HAL_H
@@ -0,0 +1,34 @@
+#ifndef HOST_SOFTWARE_SERIAL_H
+#define HOST_SOFTWARE_SERIAL_H
+
+#include "Arduino.h"
+
+/*
+ * Host SoftwareSerial
+ * Transmit is bit-banged on the real chip, so each written byte blocks
+ * the CPU for one full frame (10 bit times) on the virtual clock.
+ */
+
+class SoftwareSerial : public Stream {
+public:
+    SoftwareSerial(uint8_t rxPin, uint8_t txPin, bool inverseLogic = false);
+    ~SoftwareSerial();
+
+    void begin(long baud);
+    void end() {}
+    bool listen() { return true; }
+    bool isListening() const { return true; }
+    bool overflow() { return hostDropped() > 0; }
+    size_t write(uint8_t b) override;
+    using Print::write;
+    operator bool() const { return true; }
+
+    uint8_t rxPin() const { return _rxPin; }
+
+private:
+    uint8_t _rxPin;
+    uint8_t _txPin;
+    uint64_t _byteCycles;
+};
+
+#endif // HOST_SOFTWARE_SERIAL_H
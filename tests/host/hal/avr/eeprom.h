@@ -0,0 +1,33 @@
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+/*
+ * Host stand-in for <avr/eeprom.h>
+ * The HAL keeps 1 KB of EEPROM on the virtual clock (see HostHal.cpp): a
+ * byte write runs for 3.4 ms in the background, and any access while one
+ * is in progress waits for it, like the EEPE poll in avr-libc.
+ */
+
+#include "io.h"
+
+#define E2END 0x3FF
+
+bool hostEepromReady();
+uint8_t hostEepromRead(uint16_t address);
+void hostEepromWrite(uint16_t address, uint8_t value);
+
+#define eeprom_is_ready() hostEepromReady()
+
+inline uint8_t eeprom_read_byte(const uint8_t* address) {
+    return hostEepromRead((uint16_t)(uintptr_t)address);
+}
+
+inline void eeprom_write_byte(uint8_t* address, uint8_t value) {
+    hostEepromWrite((uint16_t)(uintptr_t)address, value);
+}
+
+inline void eeprom_update_byte(uint8_t* address, uint8_t value) {
+    if (eeprom_read_byte(address) != value) eeprom_write_byte(address, value);
+}
+
+#endif // HOST_AVR_EEPROM_H
@@ -0,0 +1,14 @@
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+/*
+ * Host stand-in for <avr/interrupt.h>
+ * ISR(vector) defines a plain function the host HAL calls when the
+ * simulated peripheral raises that interrupt.
+ */
+
+#include "io.h"
+
+#define ISR(vector, ...) extern "C" void vector(void)
+
+#endif // HOST_AVR_INTERRUPT_H
@@ -0,0 +1,104 @@
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+/*
+ * Host stand-in for <avr/io.h> (ATmega328P subset)
+ * Registers are modelled as objects so every access costs CPU cycles
+ * on the virtual clock, just like an LDS/STS on the real chip. They are
+ * constant-initialised so firmware globals may touch them from their
+ * constructors, as on the target.
+ */
+
+#include <stdint.h>
+
+void hostChargeCycles(uint32_t cycles);
+
+template <typename T>
+class HostReg {
+public:
+    constexpr HostReg(T value = 0) : _value(value) {}
+
+    operator T() const { hostChargeCycles(1); return _value; }
+    HostReg& operator=(T value) { hostChargeCycles(1); _value = value; return *this; }
+    // Compound ops take int like the real volatile register (reg &= ~_BV(n))
+    HostReg& operator|=(int bits) { hostChargeCycles(2); _value = (T)(_value | bits); return *this; }
+    HostReg& operator&=(int bits) { hostChargeCycles(2); _value = (T)(_value & bits); return *this; }
+    HostReg& operator^=(int bits) { hostChargeCycles(2); _value = (T)(_value ^ bits); return *this; }
+
+    // Uncharged access for the host core and test assertions
+    T raw() const { return _value; }
+    void setRaw(T value) { _value = value; }
+
+private:
+    T _value;
+};
+
+// GPIO
+extern HostReg<uint8_t> PORTB, PORTC, PORTD;
+extern HostReg<uint8_t> DDRB, DDRC, DDRD;
+extern HostReg<uint8_t> PINB, PINC, PIND;
+
+// Timers (Timer0: pins 5/6, Timer1: pins 9/10, Timer2: pins 3/11)
+extern HostReg<uint8_t> TCCR0A, TCCR0B, OCR0A, OCR0B;
+extern HostReg<uint8_t> TCCR1A, TCCR1B;
+extern HostReg<uint16_t> OCR1A, OCR1B;
+extern HostReg<uint8_t> TCCR2A, TCCR2B, OCR2A, OCR2B;
+
+// Status register
+extern HostReg<uint8_t> SREG;
+
+// Watchdog and reset status
+extern HostReg<uint8_t> WDTCSR, MCUSR;
+
+#ifndef _BV
+#define _BV(bit) (1 << (bit))
+#endif
+
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+#define COM0A1 7
+#define COM0A0 6
+#define COM0B1 5
+#define COM0B0 4
+#define COM1A1 7
+#define COM1A0 6
+#define COM1B1 5
+#define COM1B0 4
+#define COM2A1 7
+#define COM2A0 6
+#define COM2B1 5
+#define COM2B0 4
+
+#define SREG_I 7
+
+#define WDIF  7
+#define WDIE  6
+#define WDP3  5
+#define WDCE  4
+#define WDE   3
+#define WDP2  2
+#define WDP1  1
+#define WDP0  0
+
+#define WDRF  3
+#define BORF  2
+#define EXTRF 1
+#define PORF  0
+
+// Interrupt vectors implemented by firmware through ISR()
+#define WDT_vect host_WDT_vect
+
+#endif // HOST_AVR_IO_H
@@ -0,0 +1,36 @@
+#ifndef HOST_AVR_WDT_H
+#define HOST_AVR_WDT_H
+
+/*
+ * Host stand-in for <avr/wdt.h>
+ * The HAL runs the watchdog counter off the virtual clock (see HostHal.cpp).
+ */
+
+#include "io.h"
+
+#define WDTO_15MS  0
+#define WDTO_30MS  1
+#define WDTO_60MS  2
+#define WDTO_120MS 3
+#define WDTO_250MS 4
+#define WDTO_500MS 5
+#define WDTO_1S    6
+#define WDTO_2S    7
+#define WDTO_4S    8
+#define WDTO_8S    9
+
+void hostWdtReset();
+
+#define wdt_reset() hostWdtReset()
+
+inline void wdt_enable(uint8_t value) {
+    WDTCSR = _BV(WDCE) | _BV(WDE);
+    WDTCSR = _BV(WDE) | ((value & 0x08) ? _BV(WDP3) : 0) | (value & 0x07);
+}
+
+inline void wdt_disable() {
+    WDTCSR = _BV(WDCE) | _BV(WDE);
+    WDTCSR = 0;
+}
+
+#endif // HOST_AVR_WDT_H
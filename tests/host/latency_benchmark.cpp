@@ -0,0 +1,233 @@
+/*
+ * Command Latency Benchmark (host)
+ * Measures the time from the last byte of a command arriving at the MCU
+ * to the first write of a motor PWM/direction pin, for every protocol
+ * format, with real on-wire UART timing at 9600 and 115200 baud.
+ *
+ * The firmware sketch runs unmodified on the host HAL virtual clock, so
+ * anything that blocks the loop - Stream::readString() timeouts, delay(),
+ * blocking serial writes - shows up directly in the numbers.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -I tests/host/hal -I . tests/host/latency_benchmark.cpp \
+ *       tests/host/hal/HostHal.cpp src/BluetoothComm.cpp src/SafetySystem.cpp \
+ *       src/WormMotorController.cpp src/TaskWatchdog.cpp \
+ *       src/DriveMixer.cpp src/LinkMonitor.cpp src/LinkLossPolicy.cpp \
+ *       src/BlackBox.cpp -o latency_benchmark
+ *   ./latency_benchmark [budget_ms] [samples]
+ *
+ * Add -DBENCH_SKV3 and build only this file plus HostHal.cpp to
+ * benchmark SKV3_CombatRobot_Main.ino instead of sumo_robot_main.ino.
+ *
+ * Exit status is non-zero if any sample exceeds the latency budget, a
+ * command never reaches the motors, or a single loop() pass stalls longer
+ * than the loop budget.
+ */
+
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+#include "HostHal.h"
+#include "SoftwareSerial.h"
+
+// ============================================================================
+// FIRMWARE UNDER TEST
+// ============================================================================
+
+#include "SketchPrototypes.h"
+
+#ifdef BENCH_SKV3
+#include "../../src/SKV3_CombatRobot_Main.ino"
+
+#define BENCH_TARGET       "SKV3_CombatRobot_Main.ino"
+#define BENCH_BT_RX_PIN    BT_RX_PIN
+#else
+#include "../../src/sumo_robot_main.ino"
+
+#define BENCH_TARGET       "sumo_robot_main.ino"
+#define BENCH_BT_RX_PIN    BT_SOFT_RX
+#endif
+
+// ============================================================================
+// BENCHMARK PARAMETERS
+// ============================================================================
+
+#define BENCH_LATENCY_BUDGET_MS   50       // RESPONSE_TARGET_MS
+#define BENCH_LOOP_BUDGET_US      2000     // No pass may block: a delay(10) fails this
+#define BENCH_SAMPLES             200      // Commands per format and baud rate
+#define BENCH_GAP_MIN_MS          20       // Controller send interval range;
+#define BENCH_GAP_MAX_MS          150      // stays inside the 500ms safety timeout
+#define BENCH_GIVE_UP_MS          2000     // Command counts as lost after this
+#define BENCH_LOOP_OVERHEAD       200      // Cycles of uncharged work per loop() pass
+#define BENCH_BATTERY_ADC         757      // 11.1V through the 3:1 divider
+
+struct CommandFormat {
+    const char* name;
+    const char* frames[2];   // Alternated so every command changes the outputs
+};
+
+static const CommandFormat FORMATS[] = {
+    { "single char",       { "F\n", "S\n" } },
+    { "single char, bare", { "F", "S" } },
+    { "speed",             { "F180\n", "B120\n" } },
+    { "differential",      { "M250100\n", "M100250\n" } },
+    { "packet",            { "M250100", "M100250" } },   // Wrapped by _buildPacket()
+    { "sequenced packet",  { "M250100", "M100250" } },   // ...with a sequence number
+};
+
+static const unsigned long BAUD_RATES[] = { 9600, 115200 };
+
+static bool _trackLoops = false;
+static uint64_t _maxLoopCycles = 0;
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static uint32_t _random() {
+    // xorshift32: deterministic across platforms
+    static uint32_t state = 0x5EED1234;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static String _buildPacket(const char* body, int sequence) {
+    // !<length>[<seq>]<command><data><checksum>#, length excludes the delimiters
+    String bodyString(body);
+    if (sequence >= 0) {
+        bodyString = String((char)('0' + sequence / 10)) + String((char)('0' + sequence % 10)) + bodyString;
+    }
+    unsigned int length = bodyString.length() + 4;
+    String lengthField = length < 10 ? "0" + String(length) : String(length);
+
+    unsigned int sum = 0;
+    String covered = lengthField + bodyString;
+    for (unsigned int i = 0; i < covered.length(); i++) sum += (uint8_t)covered.charAt(i);
+    unsigned int checksum = sum % 100;
+    String checksumField = checksum < 10 ? "0" + String(checksum) : String(checksum);
+
+    return "!" + covered + checksumField + "#";
+}
+
+static String _buildFrame(const CommandFormat& format, int i) {
+    static int sequence = 0;
+    if (strcmp(format.name, "packet") == 0) return _buildPacket(format.frames[i & 1], -1);
+    if (strcmp(format.name, "sequenced packet") == 0) {
+        sequence = (sequence + 1) % 100;
+        return _buildPacket(format.frames[i & 1], sequence);
+    }
+    return String(format.frames[i & 1]);
+}
+
+static void _runLoopOnce() {
+    uint64_t start = hostNowCycles();
+    loop();
+    hostAdvanceCycles(BENCH_LOOP_OVERHEAD);
+    uint64_t elapsed = hostNowCycles() - start;
+    if (_trackLoops && elapsed > _maxLoopCycles) _maxLoopCycles = elapsed;
+}
+
+static uint32_t _motorPinMask() {
+    return (1UL << MOTOR_LEFT_PWM) | (1UL << MOTOR_LEFT_DIR1) | (1UL << MOTOR_LEFT_DIR2) |
+           (1UL << MOTOR_RIGHT_PWM) | (1UL << MOTOR_RIGHT_DIR1) | (1UL << MOTOR_RIGHT_DIR2);
+}
+
+static double _percentile(const std::vector<double>& sorted, double p) {
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+// Send one command and run the loop until it changes a motor pin.
+// Returns latency in microseconds, or a negative value if it never did.
+static double _measureCommand(Stream* port, const String& frame, unsigned long baud) {
+    // Random send time, independent of where the loop happens to be
+    uint64_t gap = hostMicrosToCycles(1000UL * BENCH_GAP_MIN_MS +
+                                      _random() % (1000UL * (BENCH_GAP_MAX_MS - BENCH_GAP_MIN_MS)));
+    uint64_t sendAt = hostNowCycles() + gap;
+
+    uint64_t lastByte = port->hostInject(frame.c_str(), frame.length(), baud, sendAt);
+    hostArmWriteProbe(_motorPinMask(), lastByte);
+
+    uint64_t giveUp = lastByte + hostMicrosToCycles(1000UL * BENCH_GIVE_UP_MS);
+    while (!hostProbeFired() && hostNowCycles() < giveUp) _runLoopOnce();
+
+    if (!hostProbeFired()) return -1.0;
+    return hostCyclesToMicros(hostProbeCycles() - lastByte);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char** argv) {
+    double budgetMs = argc > 1 ? atof(argv[1]) : BENCH_LATENCY_BUDGET_MS;
+    int samples = argc > 2 ? atoi(argv[2]) : BENCH_SAMPLES;
+    if (samples < 1) samples = 1;
+
+    #ifdef VOLTAGE_SENSE_PIN
+    hostSetAnalog(VOLTAGE_SENSE_PIN, BENCH_BATTERY_ADC);
+    #endif
+    setup();
+
+    Stream* port = hostSoftwareSerial(BENCH_BT_RX_PIN);
+    if (!port) {
+        printf("No SoftwareSerial on pin %d\n", BENCH_BT_RX_PIN);
+        return 2;
+    }
+
+    printf("Command latency: last RX byte -> motor pin write\n");
+    printf("Target: %s, budget %.1f ms, %d samples per row\n\n", BENCH_TARGET, budgetMs, samples);
+    printf("%-7s %-18s %8s %8s %8s %8s %8s %6s\n",
+           "baud", "format", "min", "p50", "p95", "p99", "max", "lost");
+    printf("%-7s %-18s %8s %8s %8s %8s %8s %6s\n",
+           "", "", "(ms)", "(ms)", "(ms)", "(ms)", "(ms)", "");
+
+    bool pass = true;
+
+    for (unsigned long baud : BAUD_RATES) {
+        for (const CommandFormat& format : FORMATS) {
+            // Warm up so the link is live and the motors are ramped
+            _trackLoops = false;
+            for (int i = 0; i < 4; i++) {
+                _measureCommand(port, _buildFrame(format, i), baud);
+            }
+
+            _trackLoops = true;
+            std::vector<double> latencies;
+            int lost = 0;
+            for (int i = 0; i < samples; i++) {
+                double latency = _measureCommand(port, _buildFrame(format, i), baud);
+                if (latency < 0) {
+                    lost++;
+                } else {
+                    latencies.push_back(latency / 1000.0);
+                }
+            }
+
+            std::sort(latencies.begin(), latencies.end());
+            if (latencies.empty()) {
+                printf("%-7lu %-18s %8s %8s %8s %8s %8s %6d\n",
+                       baud, format.name, "-", "-", "-", "-", "-", lost);
+                pass = false;
+                continue;
+            }
+
+            double worst = latencies.back();
+            printf("%-7lu %-18s %8.3f %8.3f %8.3f %8.3f %8.3f %6d%s\n",
+                   baud, format.name, latencies.front(), _percentile(latencies, 0.50),
+                   _percentile(latencies, 0.95), _percentile(latencies, 0.99), worst, lost,
+                   (worst > budgetMs || lost) ? "  OVER BUDGET" : "");
+            if (worst > budgetMs || lost) pass = false;
+        }
+    }
+
+    double maxLoopUs = hostCyclesToMicros(_maxLoopCycles);
+    printf("\nLongest loop() pass: %.3f ms (budget %.3f ms)\n",
+           maxLoopUs / 1000.0, BENCH_LOOP_BUDGET_US / 1000.0);
+    if (maxLoopUs > BENCH_LOOP_BUDGET_US) pass = false;
+
+    printf("RESULT: %s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,321 @@
+/*
+ * Link-Loss Test (host)
+ * Replays Bluetooth dropout traces - a 50 Hz command stream with gaps cut
+ * out of it - through the sketch and checks the drive output tier by tier:
+ * micro-dropouts up to LINK_HOLD_MS hold the last command, longer ones
+ * decay it without stopping, and only a gap past the radio timeout stops
+ * the robot. Also checks that a link which comes back mid-decay does not
+ * snap back to the stale command, and that noise and corrupt packets do
+ * not count as the link being alive.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -I tests/host/hal -I . tests/host/link_loss_test.cpp \
+ *       tests/host/hal/HostHal.cpp src/BluetoothComm.cpp src/SafetySystem.cpp \
+ *       src/WormMotorController.cpp src/TaskWatchdog.cpp \
+ *       src/DriveMixer.cpp src/LinkMonitor.cpp src/LinkLossPolicy.cpp \
+ *       src/BlackBox.cpp -o link_loss_test
+ *   ./link_loss_test
+ *
+ * Add -DTEST_SKV3 and build only this file plus HostHal.cpp to test
+ * SKV3_CombatRobot_Main.ino instead of sumo_robot_main.ino.
+ */
+
+#include "HostHal.h"
+#include "HostTest.h"
+#include "SoftwareSerial.h"
+
+// ============================================================================
+// FIRMWARE UNDER TEST
+// ============================================================================
+
+#include "SketchPrototypes.h"
+
+#ifdef TEST_SKV3
+#include "../../src/SKV3_CombatRobot_Main.ino"
+
+#define TEST_TARGET        "SKV3_CombatRobot_Main.ino"
+#define TEST_BT_RX_PIN     BT_RX_PIN
+#define TEST_STOP_MS       SAFETY_TIMEOUT_MS
+#else
+#include "../../src/sumo_robot_main.ino"
+
+#define TEST_TARGET        "sumo_robot_main.ino"
+#define TEST_BT_RX_PIN     BT_SOFT_RX
+#define TEST_STOP_MS       RADIO_TIMEOUT
+#endif
+
+#define TEST_BAUD          9600
+#define TEST_BATTERY_ADC   757      // 11.1V through the 3:1 divider
+#define TEST_PERIOD_MS     20       // Controller streams commands at 50 Hz
+#define TEST_LOOP_SLACK_MS 15       // The last command on the wire plus one loop pass
+
+static Stream* _port = nullptr;
+
+// What the left drive did during the last quiet spell
+static uint8_t _minDuty;
+static uint8_t _lastDuty;
+static long _stoppedAfterMs;        // -1: never reached zero
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static void _inject(const char* command) {
+    _port->hostInject(command, strlen(command), TEST_BAUD, hostNowCycles());
+}
+
+// Run the loop with nothing more arriving, tracking the left drive
+static void _quiet(unsigned long ms) {
+    uint64_t start = hostNowCycles();
+    uint64_t until = start + hostMicrosToCycles(ms * 1000UL);
+    _minDuty = 255;
+    _stoppedAfterMs = -1;
+    while (hostNowCycles() < until) {
+        loop();
+        hostAdvanceCycles(200);
+        _lastDuty = hostPinDuty(MOTOR_LEFT_PWM);
+        if (_lastDuty < _minDuty) _minDuty = _lastDuty;
+        if (_lastDuty == 0 && _stoppedAfterMs < 0) {
+            _stoppedAfterMs = (long)(hostCyclesToMicros(hostNowCycles() - start) / 1000.0);
+        }
+    }
+}
+
+// A steady stream of the same command, as a held joystick sends
+static uint8_t _stream(const char* command, unsigned long ms) {
+    for (unsigned long t = 0; t < ms; t += TEST_PERIOD_MS) {
+        _inject(command);
+        _quiet(TEST_PERIOD_MS);
+    }
+    return _lastDuty;
+}
+
+// Replay a dropout trace: one command, then the gap to the next, per entry.
+// Returns the lowest left drive duty seen over the whole trace.
+static uint8_t _replay(const char* command, const uint16_t* gaps, uint8_t count) {
+    uint8_t lowest = 255;
+    for (uint8_t i = 0; i < count; i++) {
+        _inject(command);
+        _quiet(gaps[i]);
+        if (_minDuty < lowest) lowest = _minDuty;
+    }
+    return lowest;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+static void testSingleCommandReachesSpeed() {
+    // From rest, one packet and nothing after it: the ramp still completes
+    _stream("S\n", 100);
+    CHECK_EQ(_lastDuty, 0);
+    _inject("A\n");
+    _quiet(LINK_HOLD_MS - 20);
+    CHECK_EQ(_lastDuty, 255);
+    _stream("S\n", 100);
+}
+
+static void testMicroDropoutsHold() {
+    uint8_t cruise = _stream("F\n", 200);
+    CHECK(cruise > 0);
+
+    // Drops of 50-150ms in a 50 Hz stream: no dip at all
+    static const uint16_t TRACE[] = { 20, 20, 50, 20, 20, 100, 20, 20, LINK_HOLD_MS - 5,
+                                      20, 20, 70, 20, 120, 20, 20 };
+    CHECK_EQ(_replay("F\n", TRACE, sizeof(TRACE) / sizeof(TRACE[0])), cruise);
+    CHECK_EQ(_lastDuty, cruise);
+}
+
+static void testLongerDropoutDecays() {
+    uint8_t cruise = _stream("F\n", 200);
+
+    // 200-300ms: the speed comes down through the decay but never stops
+    static const uint16_t TRACE[] = { 20, 200, 20, 20, 20, 20, 300, 20 };
+    uint8_t lowest = _replay("F\n", TRACE, sizeof(TRACE) / sizeof(TRACE[0]));
+    CHECK(lowest > 0);
+    CHECK(lowest < cruise);
+
+    // Fresh commands bring it straight back
+    CHECK_EQ(_stream("F\n", 60), cruise);
+}
+
+static void testDecayIsGradual() {
+    uint8_t cruise = _stream("F\n", 200);
+    _inject("F\n");
+
+    // Still held at the end of tier 1...
+    _quiet(LINK_HOLD_MS);
+    CHECK_EQ(_minDuty, cruise);
+
+    // ...then falling: a little 50ms in, more by 150ms, never at once
+    _quiet(50);
+    uint8_t early = _lastDuty;
+    CHECK(early < cruise);
+    CHECK(early > cruise - 60);
+    _quiet(100);
+    CHECK(_lastDuty < early);
+    CHECK(_lastDuty > 0);
+}
+
+static void testDeadLinkStopsAtTimeout() {
+    _stream("F\n", 200);
+    _inject("F\n");
+    _quiet(TEST_STOP_MS + 100);
+
+    CHECK(_stoppedAfterMs >= LINK_HOLD_MS);
+    CHECK(_stoppedAfterMs <= TEST_STOP_MS + TEST_LOOP_SLACK_MS);
+    CHECK_EQ(_lastDuty, 0);
+
+    // And the next command drives again
+    CHECK(_stream("F\n", 60) > 0);
+}
+
+static void testRecoveredLinkKeepsDecayedSpeed() {
+    uint8_t cruise = _stream("F\n", 200);
+    _inject("F\n");
+    _quiet(LINK_HOLD_MS + 100);
+    uint8_t decayed = _lastDuty;
+    CHECK(decayed < cruise);
+
+    // A status poll proves the link is back but is not a drive command:
+    // stay where the decay got to instead of lurching back to full speed
+    _inject("?\n");
+    _quiet(LINK_HOLD_MS - 20);
+    CHECK(_lastDuty <= decayed);
+    CHECK(_lastDuty > 0);
+
+    CHECK_EQ(_stream("F\n", 60), cruise);
+    _stream("S\n", 60);
+}
+
+#ifndef TEST_SKV3
+static void testRejectedTrafficDoesNotHoldLink() {
+    uint8_t cruise = _stream("F\n", 200);
+
+    // Line noise and corrupt packets keep arriving, but nothing the robot
+    // accepts: the hold must still run out and the decay begin. Timed off
+    // the clock, as every reject also sends an error back down the link.
+    uint64_t until = hostNowCycles() + hostMicrosToCycles((LINK_HOLD_MS + 100) * 1000UL);
+    for (uint8_t i = 0; hostNowCycles() < until; i++) {
+        _inject(i & 1 ? "!1307M15020077#" : "Zq\n");
+        _quiet(TEST_PERIOD_MS);
+    }
+    CHECK(_lastDuty < cruise);
+    CHECK(_lastDuty > 0);
+
+    CHECK_EQ(_stream("F\n", 60), cruise);
+    _stream("S\n", 60);
+}
+
+// LinkLossPolicy on its own, with both hold options
+
+static void testPolicyFollowsRampThroughHold() {
+    LinkLossPolicy policy;
+    policy.configure(LINK_HOLD_MS, RADIO_TIMEOUT, 5000, LINK_DECAY_RATE, true);
+    policy.begin();
+
+    int16_t left, right;
+    policy.linkAlive();
+    policy.command(200, -200);
+
+    // 50 PWM units per 10ms, with no further commands
+    hostAdvanceMicros(10000UL);
+    CHECK(policy.update(left, right));
+    CHECK_EQ(left, 50);
+    CHECK_EQ(right, -50);
+    for (uint8_t i = 0; i < 5; i++) {
+        hostAdvanceMicros(10000UL);
+        policy.update(left, right);
+    }
+    CHECK_EQ(left, 200);
+    CHECK_EQ(right, -200);
+    CHECK_EQ(policy.getTier(), LINK_TIER_HOLD);
+
+    // Settled: nothing to rewrite
+    hostAdvanceMicros(10000UL);
+    CHECK(!policy.update(left, right));
+}
+
+static void testPolicyFreezesWithoutRamp() {
+    LinkLossPolicy policy;
+    policy.configure(LINK_HOLD_MS, RADIO_TIMEOUT, 5000, LINK_DECAY_RATE, false);
+    policy.begin();
+
+    int16_t left, right;
+    policy.linkAlive();
+    policy.command(200, 120);
+    CHECK(policy.update(left, right));
+    CHECK_EQ(left, 200);
+    CHECK_EQ(right, 120);
+}
+
+static void testPolicyTiers() {
+    LinkLossPolicy policy;
+    policy.configure(LINK_HOLD_MS, RADIO_TIMEOUT, 5000, LINK_DECAY_RATE, false);
+    policy.begin();
+
+    int16_t left, right;
+    policy.linkAlive();
+    policy.command(255, -120);
+    policy.update(left, right);
+
+    // Replay at the sumo loop rate and watch the tiers go by in order
+    int16_t previous = left;
+    bool monotonic = true;
+    unsigned long decayStart = 0, stopStart = 0;
+    for (unsigned long t = 10; t <= RADIO_TIMEOUT + 20; t += 10) {
+        hostAdvanceMicros(10000UL);
+        policy.update(left, right);
+        if (left > previous || right > 0) monotonic = false;
+        previous = left;
+        if (policy.getTier() == LINK_TIER_DECAY && decayStart == 0) decayStart = t;
+        if (policy.getTier() == LINK_TIER_STOP && stopStart == 0) stopStart = t;
+    }
+    CHECK(monotonic);
+    CHECK_EQ(decayStart, (unsigned long)LINK_HOLD_MS);
+    CHECK_EQ(stopStart, (unsigned long)RADIO_TIMEOUT);
+    CHECK_EQ(left, 0);
+    CHECK_EQ(right, 0);
+    CHECK(strcmp(policy.getTierString(), "STOP") == 0);
+
+    // The link coming back alone does not restart the motors
+    policy.linkAlive();
+    hostAdvanceMicros(10000UL);
+    policy.update(left, right);
+    CHECK_EQ(policy.getTier(), LINK_TIER_HOLD);
+    CHECK_EQ(left, 0);
+}
+#endif
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main() {
+    #ifdef VOLTAGE_SENSE_PIN
+    hostSetAnalog(VOLTAGE_SENSE_PIN, TEST_BATTERY_ADC);
+    #endif
+    setup();
+
+    _port = hostSoftwareSerial(TEST_BT_RX_PIN);
+    if (!_port) {
+        printf("No SoftwareSerial on pin %d\n", TEST_BT_RX_PIN);
+        return 2;
+    }
+    printf("Target: %s\n", TEST_TARGET);
+
+    RUN_TEST(testSingleCommandReachesSpeed);
+    RUN_TEST(testMicroDropoutsHold);
+    RUN_TEST(testLongerDropoutDecays);
+    RUN_TEST(testDecayIsGradual);
+    RUN_TEST(testDeadLinkStopsAtTimeout);
+    RUN_TEST(testRecoveredLinkKeepsDecayedSpeed);
+    #ifndef TEST_SKV3
+    RUN_TEST(testRejectedTrafficDoesNotHoldLink);
+    RUN_TEST(testPolicyFollowsRampThroughHold);
+    RUN_TEST(testPolicyFreezesWithoutRamp);
+    RUN_TEST(testPolicyTiers);
+    #endif
+    return TEST_RESULT();
+}
@@ -0,0 +1,472 @@
+/*
+ * Link Monitor Test (host)
+ * Feeds LinkMonitor sequence numbers the way a flaky Bluetooth link
+ * delivers them - gaps, late copies, controller retries, wrap-around,
+ * a controller coming back after a dropout -
+ * and checks the loss/reorder/duplicate/jitter figures and when the link
+ * is declared degraded. Also checks sequenced packet parsing, every
+ * example packet in the docs, the compact ACK BluetoothComm sends for
+ * critical commands, and that a runaway line never costs the complete
+ * commands buffered ahead of it.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -I tests/host/hal -I . tests/host/link_monitor_test.cpp \
+ *       tests/host/hal/HostHal.cpp src/LinkMonitor.cpp src/BluetoothComm.cpp \
+ *       -o link_monitor_test
+ *   ./link_monitor_test       (from the root: it reads the docs)
+ *
+ * Add -DTEST_SKV3 and build only this file plus HostHal.cpp to run the same
+ * cases against the link monitor and packet parser inlined in
+ * SKV3_CombatRobot_Main.ino.
+ */
+
+#include <fstream>
+#include <string>
+#include "HostHal.h"
+#include "HostTest.h"
+#include "SoftwareSerial.h"
+
+// ============================================================================
+// FIRMWARE UNDER TEST
+// ============================================================================
+
+#ifdef TEST_SKV3
+#include "SketchPrototypes.h"
+#include "../../src/SKV3_CombatRobot_Main.ino"
+
+#define TEST_TARGET        "SKV3_CombatRobot_Main.ino"
+#define TEST_BT_RX_PIN     BT_RX_PIN
+
+// The sketch keeps its link statistics in one global struct. Give it the
+// LinkMonitor interface so the cases below run against it unchanged; each
+// monitor starts the statistics afresh, as the class constructor does.
+class LinkMonitor {
+public:
+    LinkMonitor() { linkStats = LinkStats(); }
+
+    uint8_t onPacket(uint8_t sequence, bool critical) { return linkAccept(sequence, critical); }
+    void updateSignalStrength(int rssi) { linkStats.signalStrength = rssi; }
+
+    bool isDegraded() { return linkDegraded(); }
+    unsigned long getReceived() { return linkStats.received; }
+    unsigned long getLost() { return linkStats.lost; }
+    unsigned long getReordered() { return linkStats.reordered; }
+    unsigned long getDuplicates() { return linkStats.duplicates; }
+    uint8_t getLossPercent() { return linkStats.lossAverage >> 8; }
+    uint16_t getJitterMs() { return linkStats.jitterQ4 >> 4; }
+    int getSignalStrength() { return linkStats.signalStrength; }
+
+    // The sketch prints the status line straight to the controller
+    String getStatusString() {
+        SoftwareSerial* port = hostSoftwareSerial(TEST_BT_RX_PIN);
+        port->hostClearTransmitted();
+        reportLinkStatus();
+        String status(port->hostTransmitted().c_str());
+        status.trim();
+        return status;
+    }
+};
+
+static void _beginPort() {
+    bluetooth.begin(BLUETOOTH_BAUD_RATE);
+}
+
+// Checked and split the way processPacketCommand() does it
+static bool _parsePacket(String packet, int &sequence, char &type, String &data) {
+    if (!packetChecksumValid(packet)) return false;
+    sequence = packetSequence(packet);
+    int commandIndex = sequence >= 0 ? 5 : 3;
+    type = packet.charAt(commandIndex);
+    data = packet.substring(commandIndex + 1, packet.length() - 3);
+    return true;
+}
+
+static bool _isCritical(char type) {
+    return isCriticalCommand(type);
+}
+
+static void _sendAck(uint8_t sequence) {
+    sendAck(sequence);
+}
+#else
+#include "config/robot_config.h"
+#include "include/LinkMonitor.h"
+#include "include/BluetoothComm.h"
+
+#define TEST_TARGET        "LinkMonitor"
+#define TEST_BT_RX_PIN     BT_SOFT_RX
+
+// One port for the whole run, as in the firmware
+static BluetoothComm bluetooth(BT_SOFT_RX, BT_SOFT_TX);
+
+static void _beginPort() {
+    bluetooth.begin(BLUETOOTH_BAUD);
+}
+
+static bool _parsePacket(String packet, int &sequence, char &type, String &data) {
+    return bluetooth.parsePacket(packet, sequence, type, data);
+}
+
+static bool _isCritical(char type) {
+    return BluetoothComm::isCriticalCommand(type);
+}
+
+static void _sendAck(uint8_t sequence) {
+    bluetooth.sendAck(sequence);
+}
+#endif
+
+#define TEST_PACKET_PERIOD_MS  20       // Controller sends at 50 Hz
+
+// Deliver a run of motion packets one period apart
+static void _deliver(LinkMonitor& link, uint8_t first, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        hostAdvanceMicros(TEST_PACKET_PERIOD_MS * 1000UL);
+        link.onPacket((first + i) % LINK_SEQ_MODULO, false);
+    }
+}
+
+// Build "!<length><seq><command><data><checksum>#" (seq < 0: unsequenced)
+static String _packet(int sequence, const char* body) {
+    String inner = "";
+    if (sequence >= 0) {
+        inner += (char)('0' + sequence / 10);
+        inner += (char)('0' + sequence % 10);
+    }
+    inner += body;
+
+    int length = 2 + inner.length() + 2;
+    String framed = "";
+    framed += (char)('0' + length / 10);
+    framed += (char)('0' + length % 10);
+    framed += inner;
+
+    unsigned int sum = 0;
+    for (unsigned int i = 0; i < framed.length(); i++) sum += (uint8_t)framed.charAt(i);
+    framed += (char)('0' + sum % 100 / 10);
+    framed += (char)('0' + sum % 10);
+    return "!" + framed + "#";
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+static void testCleanLink() {
+    hostReset();
+    LinkMonitor link;
+    _deliver(link, 0, 60);
+
+    CHECK_EQ(link.getReceived(), 60);
+    CHECK_EQ(link.getLost(), 0);
+    CHECK_EQ(link.getReordered(), 0);
+    CHECK_EQ(link.getDuplicates(), 0);
+    CHECK_EQ(link.getLossPercent(), 0);
+    CHECK_EQ(link.getJitterMs(), 0);
+    CHECK(!link.isDegraded());
+}
+
+static void testWrapAround() {
+    hostReset();
+    LinkMonitor link;
+
+    // 97, 98, 99, 0, 1, 2 is in order, not a jump backwards
+    _deliver(link, 97, 6);
+    CHECK_EQ(link.getReceived(), 6);
+    CHECK_EQ(link.getLost(), 0);
+    CHECK_EQ(link.getDuplicates(), 0);
+    CHECK_EQ(link.onPacket(3, false), LINK_NEW);
+    CHECK_EQ(link.onPacket(99, false), LINK_DUPLICATE);
+}
+
+static void testIsolatedLossIsTolerated() {
+    hostReset();
+    LinkMonitor link;
+    _deliver(link, 0, 20);
+
+    // Two single drops: counted, but nowhere near degraded
+    _deliver(link, 21, 10);
+    _deliver(link, 32, 10);
+    CHECK_EQ(link.getLost(), 2);
+    CHECK(link.getLossPercent() > 0);
+    CHECK(link.getLossPercent() < LINK_LOSS_LIMIT_PERCENT);
+    CHECK(!link.isDegraded());
+}
+
+static void testLossBurstDegradesThenRecovers() {
+    hostReset();
+    LinkMonitor link;
+    _deliver(link, 0, 20);
+
+    // PACKET_LOSS_THRESHOLD in a row lost
+    hostAdvanceMicros(PACKET_LOSS_THRESHOLD * TEST_PACKET_PERIOD_MS * 1000UL);
+    _deliver(link, 20 + PACKET_LOSS_THRESHOLD, 1);
+    CHECK_EQ(link.getLost(), PACKET_LOSS_THRESHOLD);
+    CHECK(link.isDegraded());
+
+    // Still degraded part way through the hold, even on a clean link
+    _deliver(link, 21 + PACKET_LOSS_THRESHOLD, LINK_DEGRADED_HOLD_MS / TEST_PACKET_PERIOD_MS / 2);
+    CHECK(link.isDegraded());
+
+    // Clean for the rest of the hold: trusted again
+    _deliver(link, 21 + PACKET_LOSS_THRESHOLD + LINK_DEGRADED_HOLD_MS / TEST_PACKET_PERIOD_MS / 2,
+             LINK_DEGRADED_HOLD_MS / TEST_PACKET_PERIOD_MS / 2 + 1);
+    CHECK(!link.isDegraded());
+}
+
+static void testSustainedLossDegrades() {
+    hostReset();
+    LinkMonitor link;
+
+    // Every third packet lost: no burst, but a third of the traffic gone
+    for (uint8_t seq = 0; seq < 90; seq += 3) {
+        _deliver(link, seq, 2);
+        hostAdvanceMicros(TEST_PACKET_PERIOD_MS * 1000UL);
+    }
+    CHECK(link.getLossPercent() >= LINK_LOSS_LIMIT_PERCENT);
+    CHECK(link.isDegraded());
+}
+
+static void testLatePacketIsReorderNotLoss() {
+    hostReset();
+    LinkMonitor link;
+    _deliver(link, 0, 10);
+
+    CHECK_EQ(link.onPacket(11, false), LINK_NEW);
+    CHECK_EQ(link.getLost(), 1);
+
+    // 10 turns up after 11
+    CHECK_EQ(link.onPacket(10, false), LINK_LATE);
+    CHECK_EQ(link.getLost(), 0);
+    CHECK_EQ(link.getReordered(), 1);
+    CHECK_EQ(link.getReceived(), 12);
+
+    // ...and a second copy of it is a duplicate
+    CHECK_EQ(link.onPacket(10, false), LINK_DUPLICATE);
+    CHECK_EQ(link.getDuplicates(), 1);
+}
+
+static void testOldPacketIsStale() {
+    hostReset();
+    LinkMonitor link;
+    _deliver(link, 0, 45);
+
+    // Further back than the duplicate window remembers
+    CHECK_EQ(link.onPacket(44 - LINK_SEQ_WINDOW, false), LINK_STALE);
+    CHECK_EQ(link.onPacket(45 - LINK_SEQ_WINDOW, false), LINK_DUPLICATE);
+}
+
+static void testResyncAfterDropout() {
+    hostReset();
+    LinkMonitor link;
+    _deliver(link, 0, 11);
+
+    // The link drops out for 50 packets while the controller keeps
+    // counting; it comes back with an e-stop at sequence 60
+    hostAdvanceMicros(50UL * TEST_PACKET_PERIOD_MS * 1000UL);
+    CHECK(50UL * TEST_PACKET_PERIOD_MS >= LINK_RESYNC_MS);
+    CHECK_EQ(link.onPacket(60, true), LINK_NEW);
+
+    // Everything after it is in order again, not stale or late
+    uint8_t accepted = 0;
+    for (uint8_t seq = 61; seq < LINK_SEQ_MODULO; seq++) {
+        hostAdvanceMicros(TEST_PACKET_PERIOD_MS * 1000UL);
+        if (link.onPacket(seq, false) == LINK_NEW) accepted++;
+    }
+    CHECK_EQ(accepted, LINK_SEQ_MODULO - 61);
+    CHECK_EQ(link.getLost(), 0);
+    CHECK_EQ(link.getDuplicates(), 0);
+    CHECK_EQ(link.getJitterMs(), 0);
+
+    // A jump without the silence is still too old to tell; the sketch runs
+    // a critical command anyway and ACKs it
+    hostAdvanceMicros((LINK_RESYNC_MS - 1) * 1000UL);
+    CHECK_EQ(link.onPacket(50, true), LINK_STALE);
+}
+
+static void testLostAcksDegrade() {
+    hostReset();
+    LinkMonitor link;
+    _deliver(link, 0, 10);
+    CHECK_EQ(link.onPacket(10, true), LINK_NEW);
+
+    // Motion duplicates say nothing about the return path
+    for (int i = 0; i < BLUETOOTH_RETRY_COUNT; i++) link.onPacket(9, false);
+    CHECK(!link.isDegraded());
+
+    // The controller resends a critical packet until it sees the ACK
+    for (int i = 1; i < BLUETOOTH_RETRY_COUNT; i++) {
+        CHECK_EQ(link.onPacket(10, true), LINK_DUPLICATE);
+        CHECK(!link.isDegraded());
+    }
+    CHECK_EQ(link.onPacket(10, true), LINK_DUPLICATE);
+    CHECK(link.isDegraded());
+}
+
+static void testJitter() {
+    hostReset();
+    LinkMonitor link;
+
+    // A skipped packet is loss, not jitter
+    _deliver(link, 0, 20);
+    hostAdvanceMicros(TEST_PACKET_PERIOD_MS * 1000UL);
+    _deliver(link, 21, 20);
+    CHECK_EQ(link.getJitterMs(), 0);
+
+    // Arrivals alternating 10ms and 30ms apart vary by 20ms each time
+    for (uint8_t i = 0; i < 80; i++) {
+        hostAdvanceMicros(i & 1 ? 30000UL : 10000UL);
+        link.onPacket((41 + i) % LINK_SEQ_MODULO, false);
+    }
+    CHECK(link.getJitterMs() >= 17 && link.getJitterMs() <= 20);
+}
+
+static void testWeakSignalDegrades() {
+    hostReset();
+    LinkMonitor link;
+    _deliver(link, 0, 10);
+
+    link.updateSignalStrength(SIGNAL_STRENGTH_THRESHOLD - 10);
+    CHECK(link.isDegraded());
+    link.updateSignalStrength(SIGNAL_STRENGTH_THRESHOLD + 20);
+    CHECK(!link.isDegraded());
+    CHECK_EQ(link.getSignalStrength(), SIGNAL_STRENGTH_THRESHOLD + 20);
+}
+
+static void testStatusString() {
+    hostReset();
+    LinkMonitor link;
+    _deliver(link, 0, 9);
+    _deliver(link, 10, 10);
+
+    String status = link.getStatusString();
+    CHECK(status.startsWith("LINK_OK"));
+    CHECK(status.indexOf("rx=19") > 0);
+    CHECK(status.indexOf("loss=5%") > 0);
+    CHECK(status.indexOf("jit=") > 0);
+}
+
+static void testSequencedPacketParsing() {
+    int sequence;
+    char type;
+    String data;
+
+    // Unsequenced packets still parse, with no sequence number
+    CHECK(_parsePacket(_packet(-1, "M150200"), sequence, type, data));
+    CHECK_EQ(sequence, -1);
+    CHECK_EQ(type, 'M');
+    CHECK(data == "150200");
+
+    CHECK(_parsePacket(_packet(7, "M150200"), sequence, type, data));
+    CHECK_EQ(sequence, 7);
+    CHECK_EQ(type, 'M');
+    CHECK(data == "150200");
+
+    CHECK(_parsePacket(_packet(42, "W1"), sequence, type, data));
+    CHECK_EQ(sequence, 42);
+    CHECK_EQ(type, 'W');
+    CHECK(_isCritical(type));
+    CHECK(!_isCritical('M'));
+
+    // The checksum covers the sequence number
+    String corrupted = _packet(42, "W1");
+    corrupted.setCharAt(4, '3');
+    CHECK(!_parsePacket(corrupted, sequence, type, data));
+}
+
+static void testDocumentedExamplesParse() {
+    // Every "!<digits>...#" packet quoted in the docs and help text must be
+    // one the parser accepts, or an app built from the docs gets nothing
+    static const char* FILES[] = { "README.md", "PROJECT_OVERVIEW.md",
+                                   "docs/android_app_commands.md", "config/robot_config.h",
+                                   "src/sumo_robot_main.ino", "src/SKV3_CombatRobot_Main.ino" };
+    int examples = 0;
+
+    for (const char* path : FILES) {
+        std::ifstream file(path);
+        CHECK(file.good());
+        std::string line;
+        while (std::getline(file, line)) {
+            for (size_t start = line.find('!'); start != std::string::npos;
+                 start = line.find('!', start + 1)) {
+                if (start + 2 >= line.size() || !isdigit(line[start + 1]) || !isdigit(line[start + 2])) {
+                    continue;
+                }
+                size_t end = line.find('#', start);
+                if (end == std::string::npos) continue;
+
+                int sequence;
+                char type;
+                String data;
+                String packet(line.substr(start, end - start + 1).c_str());
+                if (!_parsePacket(packet, sequence, type, data)) {
+                    printf("  %s: %s rejected\n", path, packet.c_str());
+                    CHECK(false);
+                }
+                examples++;
+            }
+        }
+    }
+    CHECK(examples >= 10);
+}
+
+static void testAckFormat() {
+    _beginPort();
+    SoftwareSerial* port = hostSoftwareSerial(TEST_BT_RX_PIN);
+    port->hostClearTransmitted();
+
+    // Four bytes at 9600 baud: about 4ms on the wire
+    uint64_t before = hostNowCycles();
+    _sendAck(7);
+    CHECK(port->hostTransmitted() == "K07\n");
+    CHECK(hostCyclesToMicros(hostNowCycles() - before) < 5000.0);
+}
+
+#ifndef TEST_SKV3
+static void testOverflowKeepsCompleteCommands() {
+    // Two commands, then line noise with no terminator past the buffer size
+    SoftwareSerial* port = hostSoftwareSerial(BT_SOFT_RX);
+    String burst = "F\nS\n";
+    while (burst.length() < COMMAND_BUFFER_SIZE + 12) burst += 'x';
+    uint64_t lastByte = port->hostInject(burst.c_str(), burst.length(), BLUETOOTH_BAUD, hostNowCycles());
+    hostAdvanceCycles(lastByte - hostNowCycles() + 1);
+
+    // Only the runaway tail is dropped
+    CHECK(bluetooth.hasCommand());
+    CHECK(bluetooth.readCommand() == "F");
+    CHECK(bluetooth.hasCommand());
+    CHECK(bluetooth.readCommand() == "S");
+
+    hostAdvanceMicros((COMMAND_IDLE_GAP_MS + 1) * 1000UL);
+    CHECK(bluetooth.hasCommand());
+    CHECK(bluetooth.readCommand().length() < COMMAND_BUFFER_SIZE);
+}
+#endif
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main() {
+    printf("Target: %s\n", TEST_TARGET);
+
+    RUN_TEST(testCleanLink);
+    RUN_TEST(testWrapAround);
+    RUN_TEST(testIsolatedLossIsTolerated);
+    RUN_TEST(testLossBurstDegradesThenRecovers);
+    RUN_TEST(testSustainedLossDegrades);
+    RUN_TEST(testLatePacketIsReorderNotLoss);
+    RUN_TEST(testOldPacketIsStale);
+    RUN_TEST(testResyncAfterDropout);
+    RUN_TEST(testLostAcksDegrade);
+    RUN_TEST(testJitter);
+    RUN_TEST(testWeakSignalDegrades);
+    RUN_TEST(testStatusString);
+    RUN_TEST(testSequencedPacketParsing);
+    RUN_TEST(testDocumentedExamplesParse);
+    RUN_TEST(testAckFormat);
+    #ifndef TEST_SKV3
+    RUN_TEST(testOverflowKeepsCompleteCommands);
+    #endif
+    return TEST_RESULT();
+}
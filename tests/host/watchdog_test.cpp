@@ -0,0 +1,214 @@
+/*
+ * Task Watchdog Test (host)
+ * Runs TaskWatchdog against the simulated AVR WDT: healthy tasks keep the
+ * chip alive, a stale task or a hung loop cuts the motors from the WDT
+ * interrupt and then resets, and the next boot reports why.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -I tests/host/hal -I . tests/host/watchdog_test.cpp \
+ *       tests/host/hal/HostHal.cpp src/TaskWatchdog.cpp \
+ *       src/WormMotorController.cpp -o watchdog_test
+ *   ./watchdog_test
+ */
+
+#include "HostHal.h"
+#include "HostTest.h"
+#include "config/robot_config.h"
+#include "include/TaskWatchdog.h"
+#include "include/WormMotorController.h"
+
+#define TEST_LOOP_PERIOD_US   10000     // Simulated loop period, a slow loop
+#define TEST_KILL_BUDGET_US   10        // Pre-reset hook must finish within this
+
+static WormMotorController leftMotor(MOTOR_LEFT_PWM, MOTOR_LEFT_DIR1, MOTOR_LEFT_DIR2);
+static WormMotorController rightMotor(MOTOR_RIGHT_PWM, MOTOR_RIGHT_DIR1, MOTOR_RIGHT_DIR2);
+
+static unsigned long _hookCalls = 0;
+static uint64_t _hookStart = 0;
+static uint64_t _hookEnd = 0;
+
+static void _preResetHook() {
+    _hookCalls++;
+    _hookStart = hostNowCycles();
+    leftMotor.killFromISR();
+    rightMotor.killFromISR();
+    _hookEnd = hostNowCycles();
+}
+
+static bool _motorsDead() {
+    const uint8_t pins[] = { MOTOR_LEFT_PWM, MOTOR_LEFT_DIR1, MOTOR_LEFT_DIR2,
+                             MOTOR_RIGHT_PWM, MOTOR_RIGHT_DIR1, MOTOR_RIGHT_DIR2 };
+    for (uint8_t pin : pins) {
+        if (hostPinDuty(pin) != 0) return false;
+    }
+    return true;
+}
+
+// Fresh boot with two tasks registered and the motors driving
+static void _boot(TaskWatchdog& watchdog, uint8_t& fastTask, uint8_t& slowTask) {
+    _hookCalls = 0;
+    watchdog.begin();
+    leftMotor.begin();
+    rightMotor.begin();
+    fastTask = watchdog.registerTask();
+    slowTask = watchdog.registerTask(300);
+    watchdog.attachPreResetHook(_preResetHook);
+    watchdog.enable();
+    leftMotor.setSpeed(200);
+    rightMotor.setSpeed(-200);
+}
+
+// One loop pass: feed, then check in the tasks that are still running
+static void _loopOnce(TaskWatchdog& watchdog, uint8_t fastTask, uint8_t slowTask, bool slowAlive) {
+    watchdog.update();
+    watchdog.checkIn(fastTask);
+    if (slowAlive) watchdog.checkIn(slowTask);
+    hostAdvanceMicros(TEST_LOOP_PERIOD_US);
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+static void testPowerOnIsNotWatchdogReset() {
+    hostReset();
+    TaskWatchdog watchdog;
+    watchdog.begin();
+
+    CHECK(!watchdog.wasWatchdogReset());
+    CHECK(watchdog.getResetString() == "POWER-ON");
+    CHECK_EQ(watchdog.getLastStaleTasks(), 0);
+}
+
+static void testHealthyTasksKeepChipAlive() {
+    hostReset();
+    TaskWatchdog watchdog;
+    uint8_t fastTask, slowTask;
+    _boot(watchdog, fastTask, slowTask);
+
+    // 10 seconds of normal running, well past many WDT periods
+    for (int i = 0; i < 1000; i++) _loopOnce(watchdog, fastTask, slowTask, true);
+
+    CHECK(watchdog.isHealthy());
+    CHECK_EQ(_hookCalls, 0);
+    CHECK_EQ(hostWatchdogResets(), 0);
+    CHECK(!_motorsDead());
+}
+
+static void testRegistryIsBounded() {
+    hostReset();
+    TaskWatchdog watchdog;
+    watchdog.begin();
+
+    for (int i = 0; i < WATCHDOG_MAX_TASKS; i++) {
+        CHECK(watchdog.registerTask() != WATCHDOG_INVALID_TASK);
+    }
+    CHECK_EQ(watchdog.registerTask(), WATCHDOG_INVALID_TASK);
+
+    // Unknown ids are ignored rather than corrupting memory
+    watchdog.checkIn(WATCHDOG_INVALID_TASK);
+}
+
+static void testStaleTaskCutsMotorsThenResets() {
+    hostReset();
+    TaskWatchdog watchdog;
+    uint8_t fastTask, slowTask;
+    _boot(watchdog, fastTask, slowTask);
+
+    for (int i = 0; i < 100; i++) _loopOnce(watchdog, fastTask, slowTask, true);
+
+    // The slow task dies; the loop itself keeps spinning
+    uint64_t stalledAt = hostNowCycles();
+    while (_hookCalls == 0 && hostNowCycles() - stalledAt < hostMicrosToCycles(3000000UL)) {
+        _loopOnce(watchdog, fastTask, slowTask, false);
+    }
+
+    CHECK_EQ(_hookCalls, 1);
+    CHECK(_motorsDead());
+    CHECK(hostCyclesToMicros(_hookEnd - _hookStart) <= TEST_KILL_BUDGET_US);
+
+    // Stale after 300ms, plus at most one WDT period (512ms) and a loop pass
+    double cutAfterMs = hostCyclesToMicros(_hookStart - stalledAt) / 1000.0;
+    CHECK(cutAfterMs > 300.0);
+    CHECK(cutAfterMs < 300.0 + 512.0 + 20.0);
+
+    // Motion commands after the cut are refused
+    leftMotor.setSpeed(255);
+    CHECK(_motorsDead());
+
+    // The tasks recovering does not cancel the reset
+    CHECK_EQ(hostWatchdogResets(), 0);
+    for (int i = 0; i < 60 && !hostWatchdogInReset(); i++) {
+        _loopOnce(watchdog, fastTask, slowTask, true);
+    }
+    CHECK(hostWatchdogInReset());
+    CHECK_EQ(hostWatchdogResets(), 1);
+
+    // Next boot knows which task starved the watchdog
+    hostWatchdogReboot();
+    TaskWatchdog rebooted;
+    rebooted.begin();
+    CHECK(rebooted.wasWatchdogReset());
+    CHECK_EQ(rebooted.getLastStaleTasks(), 1 << slowTask);
+    CHECK(rebooted.getResetString() == "WATCHDOG (tasks 0x2)");
+
+    // ...and only that boot: the record is consumed
+    hostWatchdogReboot();
+    TaskWatchdog again;
+    again.begin();
+    CHECK_EQ(again.getLastStaleTasks(), 0);
+}
+
+static void testHungLoopCutsMotorsThenResets() {
+    hostReset();
+    TaskWatchdog watchdog;
+    uint8_t fastTask, slowTask;
+    _boot(watchdog, fastTask, slowTask);
+
+    for (int i = 0; i < 100; i++) _loopOnce(watchdog, fastTask, slowTask, true);
+
+    // Stuck in a busy wait: no update(), no check-ins
+    uint64_t hungAt = hostNowCycles();
+    hostAdvanceMicros(600000UL);
+
+    CHECK_EQ(_hookCalls, 1);
+    CHECK(_motorsDead());
+    CHECK(hostCyclesToMicros(_hookStart - hungAt) <= 512000.0);
+    CHECK(!hostWatchdogInReset());
+
+    hostAdvanceMicros(600000UL);
+    CHECK(hostWatchdogInReset());
+
+    hostWatchdogReboot();
+    TaskWatchdog rebooted;
+    rebooted.begin();
+    CHECK(rebooted.wasWatchdogReset());
+    CHECK_EQ(rebooted.getLastStaleTasks(), (1 << fastTask) | (1 << slowTask));
+}
+
+static void testDisabledWatchdogNeverFires() {
+    hostReset();
+    TaskWatchdog watchdog;
+    uint8_t fastTask, slowTask;
+    _boot(watchdog, fastTask, slowTask);
+    watchdog.disable();
+
+    hostAdvanceMicros(5000000UL);
+
+    CHECK_EQ(_hookCalls, 0);
+    CHECK(!hostWatchdogInReset());
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main() {
+    RUN_TEST(testPowerOnIsNotWatchdogReset);
+    RUN_TEST(testHealthyTasksKeepChipAlive);
+    RUN_TEST(testRegistryIsBounded);
+    RUN_TEST(testStaleTaskCutsMotorsThenResets);
+    RUN_TEST(testHungLoopCutsMotorsThenResets);
+    RUN_TEST(testDisabledWatchdogNeverFires);
+    return TEST_RESULT();
+}
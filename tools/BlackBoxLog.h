@@ -0,0 +1,275 @@
+#ifndef BLACK_BOX_LOG_H
+#define BLACK_BOX_LOG_H
+
+/*
+ * Black-Box Log Decoder (PC side)
+ * Parses the "BB ..." lines the robot sends in answer to "LOG" and decodes
+ * the records described in include/BlackBoxFormat.h. Header-only, standard
+ * C++11, shared by tools/blackbox_dump and tests/host/blackbox_test.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <istream>
+#include "include/BlackBoxFormat.h"
+
+namespace blackbox {
+
+// One decoded sample; an idle run is one entry with repeat > 1
+struct Sample {
+    uint32_t time;          // millis() on the robot
+    int16_t left;
+    int16_t right;
+    uint8_t safety;
+    uint16_t batteryMv;     // 0 = not measured
+    char command;           // 0 = none
+    uint8_t event;
+    uint8_t repeat;
+};
+
+struct Slot {
+    uint8_t index;
+    uint16_t sequence;
+    uint8_t reason;
+    bool checksumOk;
+    std::vector<uint8_t> data;
+};
+
+struct Dump {
+    uint16_t eepromStart;
+    uint8_t slots;
+    uint16_t slotBytes;
+    uint16_t sampleMs;
+    std::vector<uint8_t> eeprom;
+    std::vector<uint8_t> ram;
+    bool complete;          // "BB END" seen
+
+    Dump() : eepromStart(0), slots(0), slotBytes(0), sampleMs(0), complete(false) {}
+};
+
+// Hex payload of a "BB <offset> <data>" line into out at offset
+inline bool parseHexLine(const std::string& text, std::vector<uint8_t>& out) {
+    size_t space = text.find(' ');
+    if (space != 4) return false;
+    char* end = nullptr;
+    unsigned long offset = strtoul(text.substr(0, 4).c_str(), &end, 16);
+    if (*end != '\0') return false;
+
+    std::string hex = text.substr(5);
+    if (hex.size() % 2 != 0) return false;
+    if (out.size() < offset + hex.size() / 2) out.resize(offset + hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        unsigned long value = strtoul(hex.substr(i, 2).c_str(), &end, 16);
+        if (*end != '\0') return false;
+        out[offset + i / 2] = (uint8_t)value;
+    }
+    return true;
+}
+
+// Feed one line of serial output; anything not starting "BB " is ignored so
+// debug prints can be interleaved. Returns false on a malformed BB line.
+inline bool parseLine(std::string line, Dump& dump, bool& inRam) {
+    while (!line.empty() && (line[line.size() - 1] == '\r' || line[line.size() - 1] == '\n')) {
+        line.erase(line.size() - 1);
+    }
+    if (line.compare(0, 3, "BB ") != 0) return true;
+    std::string body = line.substr(3);
+
+    if (body.compare(0, 7, "EEPROM ") == 0) {
+        unsigned int start, slots, slotBytes, sampleMs;
+        if (sscanf(body.c_str() + 7, "%u %u %u %u", &start, &slots, &slotBytes, &sampleMs) != 4) return false;
+        dump = Dump();
+        dump.eepromStart = start;
+        dump.slots = slots;
+        dump.slotBytes = slotBytes;
+        dump.sampleMs = sampleMs;
+        inRam = false;
+        return true;
+    }
+    if (body.compare(0, 4, "RAM ") == 0) {
+        dump.ram.assign(atoi(body.c_str() + 4), 0);
+        inRam = true;
+        return true;
+    }
+    if (body == "END") {
+        dump.complete = true;
+        return true;
+    }
+    if (body == "BUSY") return true;
+    return parseHexLine(body, inRam ? dump.ram : dump.eeprom);
+}
+
+inline bool parseDump(std::istream& in, Dump& dump) {
+    std::string line;
+    bool inRam = false;
+    bool ok = true;
+    while (std::getline(in, line)) {
+        if (!parseLine(line, dump, inRam)) ok = false;
+        if (dump.complete) break;
+    }
+    return ok && dump.complete;
+}
+
+// Valid slots, newest first
+inline std::vector<Slot> parseSlots(const Dump& dump) {
+    std::vector<Slot> slots;
+    for (uint8_t i = 0; i < dump.slots; i++) {
+        size_t base = (size_t)i * dump.slotBytes;
+        if (base + BLACKBOX_SLOT_HEADER_BYTES > dump.eeprom.size()) break;
+        const uint8_t* header = &dump.eeprom[base];
+        if ((header[0] | (header[1] << 8)) != BLACKBOX_SLOT_MAGIC) continue;
+
+        uint16_t length = header[5] | (header[6] << 8);
+        if (length > dump.slotBytes - BLACKBOX_SLOT_HEADER_BYTES ||
+            base + BLACKBOX_SLOT_HEADER_BYTES + length > dump.eeprom.size()) continue;
+
+        Slot slot;
+        slot.index = i;
+        slot.sequence = header[2] | (header[3] << 8);
+        slot.reason = header[4];
+        slot.data.assign(dump.eeprom.begin() + base + BLACKBOX_SLOT_HEADER_BYTES,
+                         dump.eeprom.begin() + base + BLACKBOX_SLOT_HEADER_BYTES + length);
+        uint8_t sum = 0;
+        for (uint8_t b : slot.data) sum += b;
+        slot.checksumOk = sum == header[7];
+
+        // Sequence numbers wrap: newer means less than half the range ahead
+        std::vector<Slot>::iterator at = slots.begin();
+        while (at != slots.end() && (int16_t)(at->sequence - slot.sequence) > 0) ++at;
+        slots.insert(at, slot);
+    }
+    return slots;
+}
+
+// Records before the first keyframe have nothing to be relative to and are
+// skipped (the ring evicts its oldest records as it wraps)
+inline std::vector<Sample> decode(const std::vector<uint8_t>& data, uint16_t sampleMs,
+                                  size_t* skipped = nullptr) {
+    std::vector<Sample> samples;
+    Sample state = Sample();
+    bool synced = false;
+    size_t i = 0;
+    if (skipped) *skipped = 0;
+
+    while (i < data.size()) {
+        uint8_t type = data[i];
+        size_t start = i;
+
+        if (type & BLACKBOX_IDLE_RUN) {
+            i++;
+            if (!synced) {
+                if (skipped) (*skipped)++;
+                continue;
+            }
+            Sample sample = state;
+            sample.time += sampleMs;
+            sample.command = 0;
+            sample.event = BLACKBOX_EVENT_NONE;
+            sample.repeat = type & BLACKBOX_IDLE_MAX;
+            samples.push_back(sample);
+            state.time += (uint32_t)sampleMs * sample.repeat;
+            continue;
+        }
+
+        if (type == BLACKBOX_KEYFRAME) {
+            if (i + BLACKBOX_KEYFRAME_BYTES > data.size()) break;
+            const uint8_t* r = &data[i];
+            state.time = r[1] | (r[2] << 8) | ((uint32_t)r[3] << 16) | ((uint32_t)r[4] << 24);
+            state.left = (int16_t)(r[5] | (r[6] << 8));
+            state.right = (int16_t)(r[7] | (r[8] << 8));
+            state.safety = r[9];
+            state.batteryMv = r[10] * BLACKBOX_BATTERY_STEP_MV;
+            state.command = (char)r[11];
+            state.event = r[12];
+            state.repeat = 1;
+            samples.push_back(state);
+            synced = true;
+            i += BLACKBOX_KEYFRAME_BYTES;
+            continue;
+        }
+
+        // Delta: payload bytes in flag order
+        size_t length = 1;
+        for (uint8_t bit = BLACKBOX_DELTA_LEFT; bit <= BLACKBOX_DELTA_EVENT; bit <<= 1) {
+            if (type & bit) length++;
+        }
+        if (i + length > data.size()) break;
+        i += length;
+        if (!synced) {
+            if (skipped) *skipped += i - start;
+            continue;
+        }
+
+        const uint8_t* p = &data[start + 1];
+        Sample sample = state;
+        sample.time += sampleMs;
+        sample.command = 0;
+        sample.event = BLACKBOX_EVENT_NONE;
+        sample.repeat = 1;
+        if (type & BLACKBOX_DELTA_LEFT)    sample.left += (int8_t)*p++;
+        if (type & BLACKBOX_DELTA_RIGHT)   sample.right += (int8_t)*p++;
+        if (type & BLACKBOX_DELTA_SAFETY)  sample.safety = *p++;
+        if (type & BLACKBOX_DELTA_BATTERY) {
+            sample.batteryMv += (int8_t)*p++ * BLACKBOX_BATTERY_STEP_MV;
+        }
+        if (type & BLACKBOX_DELTA_COMMAND) sample.command = (char)*p++;
+        if (type & BLACKBOX_DELTA_EVENT)   sample.event = *p++;
+        samples.push_back(sample);
+        state = sample;
+    }
+    return samples;
+}
+
+inline const char* eventName(uint8_t event) {
+    switch (event) {
+        case BLACKBOX_EVENT_NONE:      return "";
+        case BLACKBOX_EVENT_ESTOP:     return "ESTOP";
+        case BLACKBOX_EVENT_WATCHDOG:  return "WATCHDOG";
+        case BLACKBOX_EVENT_MATCH_END: return "MATCH_END";
+        case BLACKBOX_EVENT_REBOOT:    return "REBOOT";
+        default:                       return "?";
+    }
+}
+
+inline std::string safetyString(uint8_t safety) {
+    static const char* TIERS[] = { "HOLD", "DECAY", "STOP", "?" };
+    std::string out = TIERS[safety >> BLACKBOX_SAFETY_TIER_SHIFT];
+    if (safety & BLACKBOX_SAFETY_ESTOP)       out += " ESTOP";
+    if (safety & BLACKBOX_SAFETY_TIMEOUT)     out += " TIMEOUT";
+    if (safety & BLACKBOX_SAFETY_LOW_VOLTAGE) out += " LOW_V";
+    if (safety & BLACKBOX_SAFETY_CRITICAL)    out += " CRITICAL_V";
+    if (safety & BLACKBOX_SAFETY_WEAPON)      out += " WEAPON";
+    if (safety & BLACKBOX_SAFETY_LINK)        out += " LINK";
+    return out;
+}
+
+// "  12.350s  L  180  R -180  11.10V  HOLD WEAPON  cmd M  ESTOP"
+inline std::string formatSample(const Sample& sample, uint16_t sampleMs) {
+    char line[160];
+    int n = snprintf(line, sizeof(line), "%8lu.%03lus  L %4d  R %4d",
+                     (unsigned long)(sample.time / 1000), (unsigned long)(sample.time % 1000),
+                     sample.left, sample.right);
+    if (sample.batteryMv) {
+        n += snprintf(line + n, sizeof(line) - n, "  %2u.%02uV",
+                      sample.batteryMv / 1000, (sample.batteryMv % 1000) / 10);
+    }
+    n += snprintf(line + n, sizeof(line) - n, "  %s", safetyString(sample.safety).c_str());
+    if (sample.command >= ' ' && sample.command <= '~') {
+        n += snprintf(line + n, sizeof(line) - n, "  cmd %c", sample.command);
+    }
+    if (sample.event) {
+        n += snprintf(line + n, sizeof(line) - n, "  %s", eventName(sample.event));
+    }
+    if (sample.repeat > 1) {
+        snprintf(line + n, sizeof(line) - n, "  (unchanged x%u, %lums)",
+                 sample.repeat, (unsigned long)sample.repeat * sampleMs);
+    }
+    return line;
+}
+
+} // namespace blackbox
+
+#endif // BLACK_BOX_LOG_H
@@ -0,0 +1,205 @@
+/*
+ * Black-Box Download Tool
+ * Sends "LOG" to the robot's USB serial port, collects the "BB ..." dump
+ * and prints every saved match log (newest first) and the live RAM ring.
+ *
+ * Build from the repository root (Linux/macOS):
+ *   g++ -std=c++11 -O2 -I . tools/blackbox_dump.cpp -o blackbox_dump
+ *
+ * Usage:
+ *   ./blackbox_dump /dev/ttyUSB0            sumo_robot_main (9600 baud)
+ *   ./blackbox_dump -b 115200 /dev/ttyACM0  SKV3_CombatRobot_Main
+ *   ./blackbox_dump -s match1.txt /dev/ttyUSB0   also save the raw dump
+ *   ./blackbox_dump -f match1.txt           decode a saved dump
+ *
+ * Opening the port resets an Uno. That is harmless: the RAM ring survives
+ * the reset and the EEPROM logs are untouched, so the tool just repeats
+ * "LOG" until the robot has booted and answers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <fstream>
+#include <sstream>
+#include "tools/BlackBoxLog.h"
+
+#define DUMP_TIMEOUT_MS   20000     // Boot, motor test and a 9600 baud dump
+#define LOG_RETRY_MS      1000      // Resend "LOG" until the robot answers
+
+static unsigned long _nowMs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec * 1000UL + tv.tv_usec / 1000;
+}
+
+static speed_t _baudConstant(long baud) {
+    switch (baud) {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        default:     return 0;
+    }
+}
+
+static int _openPort(const char* path, long baud) {
+    speed_t speed = _baudConstant(baud);
+    if (speed == 0) {
+        fprintf(stderr, "Unsupported baud rate %ld\n", baud);
+        return -1;
+    }
+
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct termios tty;
+    if (tcgetattr(fd, &tty) != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tty);
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tty);
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+// Collect dump lines from the robot into text
+static bool _download(int fd, std::string& text) {
+    blackbox::Dump dump;
+    bool inRam = false;
+    bool answered = false;
+    std::string line;
+    unsigned long start = _nowMs();
+    unsigned long lastRequest = 0;
+
+    while (_nowMs() - start < DUMP_TIMEOUT_MS) {
+        if (!answered && _nowMs() - lastRequest >= LOG_RETRY_MS) {
+            if (write(fd, "LOG\n", 4) != 4) return false;
+            lastRequest = _nowMs();
+        }
+
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(fd, &readable);
+        struct timeval wait = { 0, 100000 };
+        if (select(fd + 1, &readable, nullptr, nullptr, &wait) <= 0) continue;
+
+        char buffer[256];
+        ssize_t count = read(fd, buffer, sizeof(buffer));
+        if (count < 0) return false;
+
+        for (ssize_t i = 0; i < count; i++) {
+            if (buffer[i] != '\n') {
+                line += buffer[i];
+                continue;
+            }
+            if (line.compare(0, 3, "BB ") == 0) {
+                if (line.compare(0, 10, "BB EEPROM ") == 0) answered = true;
+                if (answered) text += line + "\n";
+                if (!blackbox::parseLine(line, dump, inRam)) {
+                    fprintf(stderr, "Malformed line: %s\n", line.c_str());
+                }
+                if (dump.complete) return true;
+            }
+            line.clear();
+        }
+    }
+
+    fprintf(stderr, answered ? "Download timed out\n" : "No answer to LOG\n");
+    return false;
+}
+
+static void _printLog(const char* title, const std::vector<uint8_t>& data, uint16_t sampleMs) {
+    size_t skipped = 0;
+    std::vector<blackbox::Sample> samples = blackbox::decode(data, sampleMs, &skipped);
+    printf("%s: %u bytes, %u entries", title, (unsigned)data.size(), (unsigned)samples.size());
+    if (skipped) printf(", %u bytes before the first keyframe skipped", (unsigned)skipped);
+    printf("\n");
+    for (const blackbox::Sample& sample : samples) {
+        printf("%s\n", blackbox::formatSample(sample, sampleMs).c_str());
+    }
+    printf("\n");
+}
+
+static void _usage() {
+    fprintf(stderr, "usage: blackbox_dump [-b baud] [-s save.txt] <port>\n"
+                    "       blackbox_dump -f dump.txt\n");
+}
+
+int main(int argc, char** argv) {
+    long baud = 9600;
+    const char* savePath = nullptr;
+    const char* filePath = nullptr;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:s:f:h")) != -1) {
+        switch (opt) {
+            case 'b': baud = atol(optarg); break;
+            case 's': savePath = optarg; break;
+            case 'f': filePath = optarg; break;
+            default: _usage(); return 2;
+        }
+    }
+    if (!filePath && optind != argc - 1) {
+        _usage();
+        return 2;
+    }
+
+    std::string text;
+    if (filePath) {
+        std::ifstream file(filePath);
+        if (!file) {
+            fprintf(stderr, "%s: %s\n", filePath, strerror(errno));
+            return 1;
+        }
+        std::stringstream contents;
+        contents << file.rdbuf();
+        text = contents.str();
+    } else {
+        int fd = _openPort(argv[optind], baud);
+        if (fd < 0) return 1;
+        bool ok = _download(fd, text);
+        close(fd);
+        if (!ok) return 1;
+    }
+
+    if (savePath) {
+        std::ofstream save(savePath);
+        save << text;
+    }
+
+    std::istringstream in(text);
+    blackbox::Dump dump;
+    if (!blackbox::parseDump(in, dump)) {
+        fprintf(stderr, "Incomplete or malformed dump\n");
+        return 1;
+    }
+
+    std::vector<blackbox::Slot> slots = blackbox::parseSlots(dump);
+    printf("%u saved log(s), sample period %ums\n\n", (unsigned)slots.size(), dump.sampleMs);
+    for (const blackbox::Slot& slot : slots) {
+        char title[96];
+        snprintf(title, sizeof(title), "Log #%u (slot %u, saved on %s)%s", slot.sequence, slot.index,
+                 blackbox::eventName(slot.reason), slot.checksumOk ? "" : " CHECKSUM MISMATCH");
+        _printLog(title, slot.data, dump.sampleMs);
+    }
+    _printLog("RAM ring (not saved)", dump.ram, dump.sampleMs);
+    return 0;
+}